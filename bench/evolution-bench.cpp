@@ -0,0 +1,454 @@
+#include <new>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <iomanip>
+#include <fstream>
+#include <numbers>
+#include <optional>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "genotype.hpp"
+#include "xor-game.hpp"
+#include "xor-vec-env.hpp"
+#include "steady-state.hpp"
+#include "novelty.hpp"
+#include "population-kernel.hpp"
+#include "weight-mutation.hpp"
+#include "utility.hpp"
+
+/**
+ * End-to-end evolution benchmark.
+ *
+ * Runs a fixed set of phases with a fixed seed, population size and generation count, and prints one JSON
+ * document on stdout so that builds can be compared (NEAT_BENCH_THREADS, NEAT_LONG_DOUBLE_KERNEL, compiler):
+ *      mutation     - clone + mutate (structure, then weights) + compile, restarting from the founder every few rounds
+ *      weights      - population-wide weight mutation passes (WeightMutation) over clones of a wide founder,
+ *                     one pass counted as a generation and every changed weight as a mutation
+ *      xor          - generational evolution on XorGame, one episode per genotype (the offspring of every
+ *                     generational phase are bred like those of the mutation phase)
+ *      xor-vec      - the same on XorVecEnv, the population stepping it's lanes in lockstep through VecEvaluator
+ *      regression   - generational evolution on a synthetic curve fit, the population runs as one PopulationKernel
+ *      novelty      - generational evolution scored by NoveltySearch, the behaviour of a genotype being it's
+ *                     response curve over a few inputs (PopulationKernel), the best fitness is the best novelty
+ *      steady-state - asynchronous evolution on XorGame with NEAT_BENCH_THREADS workers
+ *
+ * Every phase is reproducible run to run, the steady-state phase only when built with NEAT_BENCH_THREADS=1
+ * (with more workers it depends on scheduling). Bytes allocated count every form of operator new. The peak RSS
+ * of a phase is the high watermark of the process while it runs: freed heap is handed back and the watermark is
+ * reset before the phase (/proc/self/clear_refs, Linux only, null elsewhere); the total is the largest of them. The phases evolving a population also report the mean
+ * bytes per genome (CompactGenes::bytes, and unique_bytes: what is not shared with other genomes) of the first
+ * and of the last population.
+ */
+
+#ifndef NEAT_BENCH_THREADS
+#define NEAT_BENCH_THREADS 4
+#endif
+
+namespace{
+        // fixed workload
+        constexpr uint64_t seed = 20240611;
+        constexpr std::size_t population = 100;
+        constexpr std::size_t generations = 50;
+        constexpr std::size_t mutation_rounds = 5000;
+        constexpr std::size_t mutation_restart = 10;
+        constexpr std::size_t weight_passes = 200;
+        constexpr std::size_t episode_ticks = 100;
+        constexpr std::size_t lanes_per_genotype = 4;
+        constexpr std::size_t regression_batch = 256;
+        constexpr std::size_t novelty_samples = 8, novelty_k = 15;
+        constexpr long double novelty_threshold = 0.5;
+        constexpr std::size_t steady_evaluations = 5000;
+
+        // heap traffic, counted by the replaced global operator new
+        std::atomic<uint64_t> allocated_bytes{0}, allocations{0};
+
+        // counted allocation, nullptr if out of memory (every block is released by std::free)
+        void* try_allocate(const std::size_t size, const std::size_t align) noexcept{
+                allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+                allocations.fetch_add(1, std::memory_order_relaxed);
+                return align <= alignof(std::max_align_t)
+                        ? std::malloc(size ? size : 1)
+                        : std::aligned_alloc(align, (size + align - 1) / align * align);
+        }
+
+        void* allocate(const std::size_t size, const std::size_t align){
+                if(void* p = try_allocate(size, align))
+                        return p;
+                throw std::bad_alloc();
+        }
+
+        // counters of one phase
+        struct Phase{
+                std::string name;
+                double seconds = 0;
+                std::optional<uint64_t> generations, mutations;
+                uint64_t evaluations = 0;
+                uint64_t bytes = 0, allocs = 0;
+                std::optional<uint64_t> peak_rss;
+                std::optional<long double> best;
+                // mean heap bytes per genome of the first and of the last population: referenced (chunks shared
+                // with other genomes included) and held alone
+                std::optional<double> genome_bytes_first, genome_unique_bytes_first;
+                std::optional<double> genome_bytes_last, genome_unique_bytes_last;
+        };
+
+        // reset the peak resident set size of the process to the current one, false if it cannot be reset
+        // - freed heap is handed back first, so that a phase is not charged for what the previous ones kept
+        bool reset_peak_rss(){
+#ifdef __GLIBC__
+                malloc_trim(0);
+#endif
+                std::ofstream clear("/proc/self/clear_refs");
+                clear << "5";
+                clear.flush();
+                return static_cast<bool>(clear);
+        }
+
+        // peak resident set size of the process since the last reset, in bytes (VmHWM)
+        std::optional<uint64_t> peak_rss(){
+                std::ifstream status("/proc/self/status");
+                for(std::string key; status >> key;){
+                        if(key == "VmHWM:"){
+                                uint64_t kb = 0;
+                                if(status >> kb)
+                                        return kb * 1024;
+                                break;
+                        }
+                        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                }
+                return std::nullopt;
+        }
+
+        // run a phase with a freshly seeded generator, and measure it
+        Phase measure(const std::string& name, const std::function<void(Phase&)>& body){
+                Phase phase;
+                phase.name = name;
+                rand_seed(seed);
+                const bool tracked = reset_peak_rss();
+                const uint64_t bytes = allocated_bytes, allocs = allocations;
+                const auto start = std::chrono::steady_clock::now();
+                body(phase);
+                phase.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                phase.bytes = allocated_bytes - bytes;
+                phase.allocs = allocations - allocs;
+                if(tracked)
+                        phase.peak_rss = peak_rss();
+                return phase;
+        }
+
+        // mean heap bytes per genome of a population, referenced and held alone
+        void genome_bytes(const std::vector<Genotype>& pop, std::optional<double>& bytes, std::optional<double>& unique){
+                bytes = unique = 0;
+                for(auto& geno : pop){
+                        *bytes += static_cast<double>(geno.get_genes().bytes());
+                        *unique += static_cast<double>(geno.get_genes().unique_bytes());
+                }
+                *bytes /= static_cast<double>(pop.size());
+                *unique /= static_cast<double>(pop.size());
+        }
+
+        // clone and mutate a parent (structure, then weights), retrying when the mutation leaves a cyclic network
+        Genotype offspring(const Genotype& parent, Phase& phase, WeightMutation& weights){
+                for(int attempt = 0; attempt < 3; ++attempt){
+                        Genotype child = parent.clone();
+                        try{
+                                *phase.mutations += 1;
+                                child.mutate();
+                                weights.apply(child);
+                                child.compile();
+                                return child;
+                        }catch(const std::runtime_error&){
+                        }
+                }
+                return parent.clone();
+        }
+
+        // initial population: clones of a minimal network
+        std::vector<Genotype> founders(const int inputs, const int outputs){
+                const Genotype founder(inputs, outputs);
+                std::vector<Genotype> pop;
+                for(std::size_t i = 0; i < population; ++i)
+                        pop.push_back(founder.clone());
+                return pop;
+        }
+
+        // keep the fitter half, refill the population with offspring of the survivors
+        void select(std::vector<Genotype>& pop, Phase& phase, WeightMutation& weights){
+                std::stable_sort(pop.begin(), pop.end(), [](const Genotype& a, const Genotype& b){
+                        return a.fitness > b.fitness;
+                });
+                phase.best = std::max(phase.best.value_or(pop.front().fitness), pop.front().fitness);
+                const std::size_t survivors = std::max<std::size_t>(pop.size() / 2, 1);
+                for(std::size_t i = survivors; i < pop.size(); ++i)
+                        pop.at(i) = offspring(pop.at(i % survivors), phase, weights);
+                *phase.generations += 1;
+        }
+
+        void mutation_phase(Phase& phase){
+                phase.mutations = 0;
+                const Genotype founder(8, 4);
+                Genotype current = founder.clone();
+                WeightMutation weights({});
+                for(std::size_t round = 0; round < mutation_rounds; ++round)
+                        current = round % mutation_restart == 0 ? founder.clone() : offspring(current, phase, weights);
+        }
+
+        void weights_phase(Phase& phase){
+                phase.generations = phase.mutations = 0;
+                std::vector<Genotype> pop;
+                const Genotype founder(32, 16);
+                for(std::size_t i = 0; i < population; ++i)
+                        pop.push_back(founder.clone());
+                std::vector<Genotype*> members;
+                for(auto& geno : pop)
+                        members.push_back(&geno);
+                WeightMutation mutation({});
+                genome_bytes(pop, phase.genome_bytes_first, phase.genome_unique_bytes_first);
+                for(std::size_t pass = 0; pass < weight_passes; ++pass){
+                        *phase.mutations += mutation.apply(members);
+                        *phase.generations += 1;
+                }
+                genome_bytes(pop, phase.genome_bytes_last, phase.genome_unique_bytes_last);
+        }
+
+        void xor_phase(Phase& phase){
+                phase.generations = phase.mutations = 0;
+                std::vector<Genotype> pop = founders(2, 1);
+                WeightMutation weights({});
+                genome_bytes(pop, phase.genome_bytes_first, phase.genome_unique_bytes_first);
+                XorGame game(2);
+                const EvalBudget budget{.max_ticks = episode_ticks};
+                for(std::size_t gen = 0; gen < generations; ++gen){
+                        for(auto& geno : pop){
+                                game.loop(geno, budget);
+                                ++phase.evaluations;
+                        }
+                        select(pop, phase, weights);
+                }
+                genome_bytes(pop, phase.genome_bytes_last, phase.genome_unique_bytes_last);
+        }
+
+        void xor_vec_phase(Phase& phase){
+                phase.generations = phase.mutations = 0;
+                std::vector<Genotype> pop = founders(2, 1);
+                WeightMutation weights({});
+                genome_bytes(pop, phase.genome_bytes_first, phase.genome_unique_bytes_first);
+                XorVecEnv env(population * lanes_per_genotype, 2, episode_ticks);
+                for(std::size_t gen = 0; gen < generations; ++gen){
+                        std::vector<Genotype*> members;
+                        for(auto& geno : pop)
+                                members.push_back(&geno);
+                        VecEvaluator evaluator(members);
+                        evaluator.run(env, episode_ticks);
+                        phase.evaluations += pop.size();
+                        select(pop, phase, weights);
+                }
+                genome_bytes(pop, phase.genome_bytes_last, phase.genome_unique_bytes_last);
+        }
+
+        void regression_phase(Phase& phase){
+                phase.generations = phase.mutations = 0;
+                // fit 0.5 + 0.5 sin(pi x) over [-1, 1]
+                std::vector<PopulationKernel::Scalar> inputs(regression_batch), targets(regression_batch);
+                for(std::size_t b = 0; b < regression_batch; ++b){
+                        inputs.at(b) = -1 + 2 * static_cast<PopulationKernel::Scalar>(b) / (regression_batch - 1);
+                        targets.at(b) = 0.5 + 0.5 * std::sin(std::numbers::pi * inputs.at(b));
+                }
+
+                std::vector<Genotype> pop = founders(1, 1);
+                WeightMutation weights({});
+                genome_bytes(pop, phase.genome_bytes_first, phase.genome_unique_bytes_first);
+                for(std::size_t gen = 0; gen < generations; ++gen){
+                        std::vector<std::shared_ptr<const CompiledNet>> nets;
+                        for(auto& geno : pop)
+                                nets.push_back(geno.compile());
+                        PopulationKernel kernel(nets);
+                        kernel.evaluate(inputs, regression_batch);
+                        for(std::size_t n = 0; n < pop.size(); ++n){
+                                const PopulationKernel::Scalar* out = kernel.output(n, 0);
+                                long double error = 0;
+                                for(std::size_t b = 0; b < regression_batch; ++b)
+                                        error += (out[b] - targets[b]) * (out[b] - targets[b]);
+                                pop.at(n).fitness = 1 / (1 + error / regression_batch);
+                        }
+                        phase.evaluations += pop.size();
+                        select(pop, phase, weights);
+                }
+                genome_bytes(pop, phase.genome_bytes_last, phase.genome_unique_bytes_last);
+        }
+
+        void novelty_phase(Phase& phase){
+                phase.generations = phase.mutations = 0;
+                std::vector<PopulationKernel::Scalar> inputs(novelty_samples);
+                for(std::size_t b = 0; b < novelty_samples; ++b)
+                        inputs.at(b) = -1 + 2 * static_cast<PopulationKernel::Scalar>(b) / (novelty_samples - 1);
+
+                std::vector<Genotype> pop = founders(1, 1);
+                WeightMutation weights({});
+                genome_bytes(pop, phase.genome_bytes_first, phase.genome_unique_bytes_first);
+                NoveltySearch novelty(novelty_k, novelty_threshold, NEAT_BENCH_THREADS);
+                for(std::size_t gen = 0; gen < generations; ++gen){
+                        std::vector<std::shared_ptr<const CompiledNet>> nets;
+                        for(auto& geno : pop)
+                                nets.push_back(geno.compile());
+                        PopulationKernel kernel(nets);
+                        kernel.evaluate(inputs, novelty_samples);
+                        std::vector<Genotype*> members;
+                        for(std::size_t n = 0; n < pop.size(); ++n){
+                                const PopulationKernel::Scalar* out = kernel.output(n, 0);
+                                pop.at(n).behaviour.assign(out, out + novelty_samples);
+                                members.push_back(&pop.at(n));
+                        }
+                        novelty.assign(members);
+                        phase.evaluations += pop.size();
+                        select(pop, phase, weights);
+                }
+                genome_bytes(pop, phase.genome_bytes_last, phase.genome_unique_bytes_last);
+        }
+
+        void steady_state_phase(Phase& phase){
+                SteadyState::Config config;
+                config.capacity = population;
+                config.threads = NEAT_BENCH_THREADS;
+                config.budget.max_ticks = episode_ticks;
+                SteadyState evolution(2, 1, config, []{ return std::make_unique<XorGame>(2); });
+                evolution.run(steady_evaluations);
+                phase.evaluations = steady_evaluations;
+                phase.best = evolution.best()->fitness;
+        }
+
+        // quantities a phase does not measure are reported as null (counts are printed exactly)
+        template<typename T>
+        std::string optional_value(const std::optional<T>& value){
+                std::ostringstream res;
+                res << std::setprecision(6);
+                if(value && std::is_integral_v<T>)
+                        res << *value;
+                else if(value)
+                        res << static_cast<double>(*value);
+                else
+                        res << "null";
+                return res.str();
+        }
+
+        std::string optional_rate(const std::optional<uint64_t>& count, const double seconds){
+                std::ostringstream rate;
+                rate << std::setprecision(6);
+                if(count)
+                        rate << *count / seconds;
+                else
+                        rate << "null";
+                return rate.str();
+        }
+
+        void print_phase(std::ostream& out, const Phase& phase, const std::string& indent){
+                out << indent << "\"name\": \"" << phase.name << "\",\n"
+                    << indent << "\"seconds\": " << phase.seconds << ",\n"
+                    << indent << "\"generations\": " << optional_value(phase.generations) << ",\n"
+                    << indent << "\"evaluations\": " << phase.evaluations << ",\n"
+                    << indent << "\"mutations\": " << optional_value(phase.mutations) << ",\n"
+                    << indent << "\"generations_per_sec\": " << optional_rate(phase.generations, phase.seconds) << ",\n"
+                    << indent << "\"evaluations_per_sec\": " << optional_rate(phase.evaluations, phase.seconds) << ",\n"
+                    << indent << "\"mutations_per_sec\": " << optional_rate(phase.mutations, phase.seconds) << ",\n"
+                    << indent << "\"bytes_allocated\": " << phase.bytes << ",\n"
+                    << indent << "\"allocations\": " << phase.allocs << ",\n"
+                    << indent << "\"peak_rss_bytes\": " << optional_value(phase.peak_rss) << ",\n"
+                    << indent << "\"genome_bytes_first\": " << optional_value(phase.genome_bytes_first) << ",\n"
+                    << indent << "\"genome_unique_bytes_first\": " << optional_value(phase.genome_unique_bytes_first) << ",\n"
+                    << indent << "\"genome_bytes_last\": " << optional_value(phase.genome_bytes_last) << ",\n"
+                    << indent << "\"genome_unique_bytes_last\": " << optional_value(phase.genome_unique_bytes_last) << ",\n"
+                    << indent << "\"best_fitness\": " << optional_value(phase.best) << "\n";
+        }
+}
+
+// replace every form of the global allocation functions to count the heap traffic (the library allocates
+// through several of them, e.g. std::stable_sort through the nothrow form): all of them allocate through
+// try_allocate and release through std::free, so any new / delete pairing stays consistent
+void* operator new(std::size_t size) { return allocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size) { return allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return try_allocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return try_allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t align) { return allocate(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocate(size, static_cast<std::size_t>(align)); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept{
+        return try_allocate(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept{
+        return try_allocate(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+int main(){
+        std::vector<Phase> phases;
+        phases.push_back(measure("mutation", mutation_phase));
+        phases.push_back(measure("weights", weights_phase));
+        phases.push_back(measure("xor", xor_phase));
+        phases.push_back(measure("xor-vec", xor_vec_phase));
+        phases.push_back(measure("regression", regression_phase));
+        phases.push_back(measure("novelty", novelty_phase));
+        phases.push_back(measure("steady-state", steady_state_phase));
+
+        // totals: counts are summed over the phases that report them, the peak RSS is the largest phase peak
+        // (fitness is not comparable across phases)
+        Phase total;
+        total.name = "total";
+        total.generations = total.mutations = 0;
+        for(auto& phase : phases){
+                total.seconds += phase.seconds;
+                *total.generations += phase.generations.value_or(0);
+                *total.mutations += phase.mutations.value_or(0);
+                total.evaluations += phase.evaluations;
+                total.bytes += phase.bytes;
+                total.allocs += phase.allocs;
+                if(phase.peak_rss)
+                        total.peak_rss = std::max(total.peak_rss.value_or(0), *phase.peak_rss);
+        }
+
+        std::cout << std::setprecision(6);
+        std::cout << "{\n"
+                  << "  \"config\": {\n"
+                  << "    \"seed\": " << seed << ",\n"
+                  << "    \"population\": " << population << ",\n"
+                  << "    \"generations\": " << generations << ",\n"
+                  << "    \"threads\": " << NEAT_BENCH_THREADS << ",\n"
+                  << "    \"scalar\": \"" << (sizeof(CompiledNet::Scalar) == sizeof(float) ? "float" : "long double") << "\"\n"
+                  << "  },\n"
+                  << "  \"phases\": [\n";
+        for(std::size_t p = 0; p < phases.size(); ++p){
+                std::cout << "    {\n";
+                print_phase(std::cout, phases.at(p), "      ");
+                std::cout << (p + 1 < phases.size() ? "    },\n" : "    }\n");
+        }
+        std::cout << "  ],\n"
+                  << "  \"total\": {\n";
+        print_phase(std::cout, total, "    ");
+        std::cout << "  }\n"
+                  << "}\n";
+        return 0;
+}
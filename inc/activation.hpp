@@ -0,0 +1,79 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "gene.hpp"
+
+using std::int32_t;
+using std::uint32_t;
+
+// fast approximations of the node activation functions
+// - no libm calls and no data dependent branches, so the loops over a range of values vectorize
+// - exp is split as 2^n * 2^f (n the nearest integer, |f| <= 1/2), 2^f is a degree 6 polynomial and 2^n is
+//   a float built straight from it's exponent bits; sin reduces it's argument to [-pi/2, pi/2] and uses a degree 11
+//   polynomial
+// - maximum error against the float libm functions over inputs in [-1e4, 1e4] (measured):
+//   exp ~1e-6 relative (for |x| <= 20), sigmoid / tanh / gaussian / sin ~2e-7 absolute, relu / identity exact
+// - results rely on IEEE float rounding, do not compile with -ffast-math
+// - the long double overloads (NEAT_LONG_DOUBLE_KERNEL builds) are the exact libm reference instead
+struct FastActivation{
+    public:
+        static float exp(const float x) noexcept{
+                // round t to the nearest integer (1.5 * 2^23 trick), then clamp the exponent to the normal range
+                // - the operands are ordered so that a NaN r clamps to 126: the conversion below is always defined,
+                //   the NaN stays in f and p, and 2^n is applied by a multiplication so that it survives
+                // - x = +-inf gives NaN (f = inf - inf); clamping t as well would keep the loops from vectorizing
+                const float t = x * 1.44269504f;
+                const float r = (t + 12582912.0f) - 12582912.0f;
+                const float f = t - r;
+                const float n = std::max(-126.0f, std::min(126.0f, r));
+                float p = 1.54035304e-4f;
+                p = p * f + 1.33335581e-3f;
+                p = p * f + 9.61812911e-3f;
+                p = p * f + 5.55041087e-2f;
+                p = p * f + 2.40226507e-1f;
+                p = p * f + 6.93147181e-1f;
+                p = p * f + 1.0f;
+                return p * std::bit_cast<float>((static_cast<int32_t>(n) + 127) << 23);
+        }
+
+        static float sin(const float x) noexcept{
+                // x = k * pi + r, pi split in three parts (Cody-Waite) so that r stays acturate for large k
+                // - k is read from s = x / pi + 1.5 * 2^23, whose last mantissa bit is the parity of k: no float to
+                //   integer conversion, so a NaN or an out of range x stays defined (the NaN stays in r and p);
+                //   past |x| = 2^22 the reduction no longer holds and the result is meaningless
+                const float s = x * 0.318309886f + 12582912.0f;
+                const float k = s - 12582912.0f;
+                float r = x - k * 3.140625f;
+                r -= k * 9.67502593994140625e-4f;
+                r -= k * 1.509957990978376432e-7f;
+                // sin(x) = (-1)^k * sin(r): flip the sign bit when k is odd
+                const float r2 = r * r;
+                float p = -2.50521084e-8f;
+                p = p * r2 + 2.75573192e-6f;
+                p = p * r2 - 1.98412698e-4f;
+                p = p * r2 + 8.33333333e-3f;
+                p = p * r2 - 1.66666667e-1f;
+                p = p * r2 * r + r;
+                return std::bit_cast<float>(std::bit_cast<uint32_t>(p) ^ (std::bit_cast<uint32_t>(s) << 31));
+        }
+
+        // steepened sigmoid from the NEAT paper
+        static float sigmoid(const float x) noexcept { return 1.0f / (1.0f + exp(-4.9f * x)); }
+        static float tanh(const float x) noexcept { return 2.0f / (1.0f + exp(-2.0f * x)) - 1.0f; }
+        static float relu(const float x) noexcept { return std::max(x, 0.0f); }
+        static float gaussian(const float x) noexcept { return exp(-x * x); }
+        static float identity(const float x) noexcept { return x; }
+
+        // apply an activation function to a single value
+        static float apply(const Activation activation, const float x) noexcept;
+
+        // apply an activation function to n contiguous values, in place (one branch-free loop per function)
+        static void apply(const Activation activation, float* const values, const std::size_t n) noexcept;
+
+        // exact versions in long double
+        static long double apply(const Activation activation, const long double x) noexcept;
+        static void apply(const Activation activation, long double* const values, const std::size_t n) noexcept;
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <map>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <coroutine>
+#include "genotype.hpp"
+
+using std::uint64_t;
+
+class EvalScheduler;
+
+/**
+ * This file defines the coroutine flavour of the evaluation framework (see eval-interface.hpp).
+ *
+ * EvalInterface::loop blocks the calling thread for the whole episode, so an environment that
+ * has to wait (simulated latency, a stepped external simulator, a mock service, etc.) burns one
+ * thread per genotype. Here collect and acturate are coroutines: they can co_await the scheduler
+ * instead of blocking, and EvalScheduler multiplexes all the episodes over a small thread pool.
+ *
+ * To implement your own coroutine evaluation protocal, simply:
+ *
+ * 1. Inheriate this interface class
+ * 2. Implement it's virtual methods (collect and acturate must co_return their result)
+ * 3. Instantiate ONE object per episode and hand it to EvalScheduler::spawn
+ */
+
+// lazily started coroutine returning a value of type T to the coroutine awaiting it
+template<typename T>
+class CoTask{
+    public:
+        struct promise_type{
+                std::optional<T> value;
+                std::exception_ptr error;
+                // the coroutine to resume once this task has finished
+                std::coroutine_handle<> continuation = std::noop_coroutine();
+
+                CoTask get_return_object() noexcept {
+                        return CoTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+                std::suspend_always initial_suspend() const noexcept { return {}; }
+                auto final_suspend() const noexcept {
+                        // transfer control back to the awaiting coroutine (symmetric transfer, no stack growth)
+                        struct FinalAwaiter{
+                                bool await_ready() const noexcept { return false; }
+                                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) const noexcept {
+                                        return h.promise().continuation;
+                                }
+                                void await_resume() const noexcept {}
+                        };
+                        return FinalAwaiter{};
+                }
+                void return_value(T v) { value.emplace(std::move(v)); }
+                void unhandled_exception() noexcept { error = std::current_exception(); }
+        };
+
+        CoTask(CoTask&& other) noexcept : handle{std::exchange(other.handle, nullptr)} {}
+        CoTask(const CoTask&) = delete;
+        CoTask& operator=(const CoTask&) = delete;
+        ~CoTask() { if(handle) handle.destroy(); }
+
+        // start the task and suspend the caller until the task co_returns
+        auto operator co_await() && noexcept {
+                struct Awaiter{
+                        std::coroutine_handle<promise_type> handle;
+
+                        bool await_ready() const noexcept { return handle.done(); }
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) const noexcept {
+                                handle.promise().continuation = caller;
+                                return handle;
+                        }
+                        T await_resume() const {
+                                if(handle.promise().error)
+                                        std::rethrow_exception(handle.promise().error);
+                                return std::move(*handle.promise().value);
+                        }
+                };
+                return Awaiter{handle};
+        }
+
+    private:
+        explicit CoTask(std::coroutine_handle<promise_type> h) noexcept : handle{h} {}
+
+        std::coroutine_handle<promise_type> handle;
+};
+
+// top-level coroutine of one episode - owned and destroyed by the EvalScheduler
+class CoEpisode{
+    public:
+        struct promise_type{
+                EvalScheduler* sched = nullptr;
+
+                CoEpisode get_return_object() noexcept {
+                        return CoEpisode{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+                // report to the scheduler and release the coroutine frame once the episode has ended
+                struct FinalAwaiter{
+                        bool await_ready() const noexcept { return false; }
+                        void await_suspend(std::coroutine_handle<promise_type> h) const noexcept;
+                        void await_resume() const noexcept {}
+                };
+
+                std::suspend_always initial_suspend() const noexcept { return {}; }
+                FinalAwaiter final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+                void unhandled_exception() noexcept { error = std::current_exception(); }
+
+                std::exception_ptr error;
+        };
+
+        CoEpisode(CoEpisode&& other) noexcept : handle{std::exchange(other.handle, nullptr)} {}
+        CoEpisode(const CoEpisode&) = delete;
+        CoEpisode& operator=(const CoEpisode&) = delete;
+        ~CoEpisode() { if(handle) handle.destroy(); }
+
+        // hand the ownership of the coroutine frame over (to the scheduler)
+        std::coroutine_handle<promise_type> release() noexcept { return std::exchange(handle, nullptr); }
+
+    private:
+        explicit CoEpisode(std::coroutine_handle<promise_type> h) noexcept : handle{h} {}
+
+        std::coroutine_handle<promise_type> handle;
+};
+
+// suspend an episode until the deadline - the worker thread moves on to other episodes meanwhile
+struct CoDelay{
+        EvalScheduler& sched;
+        std::chrono::steady_clock::time_point deadline;
+
+        bool await_ready() const noexcept { return std::chrono::steady_clock::now() >= deadline; }
+        void await_suspend(std::coroutine_handle<> h) const;
+        void await_resume() const noexcept {}
+};
+
+class CoEvalInterface{
+    public:
+        using DataPkt = std::map<uint64_t,long double>;
+
+        /**
+         * virtual destructor:
+         * - can choose to implement in derived class (in case you want to release some memory)
+         * - if not implemented, DO NOTHING destructor will be used!
+         */
+        virtual ~CoEvalInterface() { /* DO NOTHING!~ */ };
+
+        /**
+         * game loop (coroutine):
+         * - same 4 steps per game tick as EvalInterface::loop
+         * - collect and acturate may suspend, the network propogation is handed to the scheduler
+         *   so that it can be batched with the propogations of the other ready episodes
+         * - never call this directly, use EvalScheduler::spawn
+         */
+        CoEpisode loop(Genotype& geno);
+
+    protected:
+        // suspend the episode for a while WITHOUT blocking the worker thread (simulated latency, etc.)
+        CoDelay delay(const std::chrono::nanoseconds duration) const;
+
+    private:
+        friend class EvalScheduler; // the scheduler attaches itself before starting the episode
+
+        /**
+         * genotype and game initialization:
+         *  - initialize the needed entries
+         *  - must implement in derived classes
+         */
+        virtual void initialize(Genotype& geno) = 0;
+
+        /**
+         * data collection (coroutine):
+         * - collect necessary data to feed into the network from the outside world (game, etc.)
+         * - must implement in derived class, co_return the DataPkt for each sensor node
+         */
+        virtual CoTask<DataPkt> collect() = 0;
+
+        /**
+         * acturate (reflect) (coroutine):
+         * - using the calculated data to acturate the outside world (game, etc.)
+         * - must implement in derived class
+         * - must co_return a boolean to indicate if the evaluation has finished or not
+         */
+        virtual CoTask<bool> acturate(const DataPkt& pkt) = 0;
+
+        /**
+         * calculate score:
+         * - calculate the new score based on the previous score
+         * - must implement in derived class (your own score update policy)
+         */
+        virtual long double upd_score(const long double old_score) const = 0;
+
+        /**
+         * behaviour descriptor:
+         * - characterize what the genotype did during the game, stored in Genotype::behaviour
+         * - can choose to implement in derived class, the default reports no behaviour
+         */
+        virtual std::vector<long double> behaviour() const { return {}; }
+
+        // the scheduler driving this episode
+        EvalScheduler* sched = nullptr;
+};
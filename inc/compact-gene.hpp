@@ -0,0 +1,199 @@
+#pragma once
+
+#include <list>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "gene.hpp"
+
+using std::uint8_t;
+using std::uint32_t;
+using std::uint64_t;
+
+// packed storage of a genotype's node genes and connection genes
+// - node numbers and innovation numbers are 32 bits, weights and biases are floats
+// - every field lives in it's own array (structure of arrays), the enable flags are packed into a bitset
+// - about 16 bytes per connection gene, against ~64 for a Connection in a std::list
+// - the arrays are cut into chunks of chunk_size genes; the last chunk is sized to the genes it holds (it starts
+//   at min_chunk_capacity and doubles as it fills), so a small genome holds a few hundred bytes
+// - chunks are immutable once shared, along with the list of chunks (copy-on-write): copying the genes is O(1),
+//   a change copies the list of chunks and the one chunk it touches, unchanged chunks stay shared between
+//   parent and child. Whether something is shared is an explicit flag raised by the copy, never read from a
+//   reference count (those are only approximate while other threads copy or drop the genes)
+// - Node and Connection remain the exchange format: use the conversions for I/O and debugging
+class CompactGenes{
+    public:
+        // genes per full chunk (one 64 bit word of enable flags)
+        static constexpr std::size_t chunk_size = 64;
+        // capacity of a new chunk
+        static constexpr std::size_t min_chunk_capacity = 4;
+
+        CompactGenes() = default;
+        // the copy shares the chunks: both sides see them flagged as shared from then on
+        CompactGenes(const CompactGenes& other) noexcept;
+        CompactGenes& operator=(const CompactGenes& other) noexcept;
+        CompactGenes(CompactGenes&& other) noexcept = default;
+        CompactGenes& operator=(CompactGenes&& other) noexcept = default;
+
+        // pack plain gene containers - throws if a node number or innovation number needs more than 32 bits
+        template<typename Nodes, typename Connections>
+        explicit CompactGenes(const Nodes& nodes, const Connections& connections){
+                for(auto& node : nodes)
+                        add_node(node);
+                for(auto& connection : connections)
+                        add_connection(connection);
+        }
+
+        // unpack into the plain gene structs
+        Node node(const std::size_t i) const;
+        Connection connection(const std::size_t i) const;
+        std::list<Node> nodes() const;
+        std::list<Connection> connections() const;
+
+        // append a gene - throws if a node number or innovation number needs more than 32 bits
+        void add_node(const Node& node);
+        void add_connection(const Connection& connection);
+
+        // node genes
+        std::size_t node_count() const noexcept { return node_total; }
+        uint32_t node_number(const std::size_t i) const { return node_at(i).numbers()[i % chunk_size]; }
+        NodeType node_type(const std::size_t i) const { return static_cast<NodeType>(node_at(i).types()[i % chunk_size]); }
+        Activation activation(const std::size_t i) const { return static_cast<Activation>(node_at(i).activations()[i % chunk_size]); }
+        float bias(const std::size_t i) const { return node_at(i).biases()[i % chunk_size]; }
+        void set_activation(const std::size_t i, const Activation activation){
+                writable(node_chunks, i / chunk_size).activations()[i % chunk_size] = static_cast<uint8_t>(activation);
+        }
+        void set_bias(const std::size_t i, const float bias) { writable(node_chunks, i / chunk_size).biases()[i % chunk_size] = bias; }
+
+        // connection genes
+        std::size_t connection_count() const noexcept { return connection_total; }
+        uint32_t in(const std::size_t i) const { return connection_at(i).ins()[i % chunk_size]; }
+        uint32_t out(const std::size_t i) const { return connection_at(i).outs()[i % chunk_size]; }
+        uint32_t innov(const std::size_t i) const { return connection_at(i).innovs()[i % chunk_size]; }
+        float weight(const std::size_t i) const { return connection_at(i).weights()[i % chunk_size]; }
+        bool enabled(const std::size_t i) const { return (connection_at(i).enable_bits >> (i % chunk_size)) & 1; }
+        void set_weight(const std::size_t i, const float weight) { writable(connection_chunks, i / chunk_size).weights()[i % chunk_size] = weight; }
+        void set_enable(const std::size_t i, const bool enable){
+                uint64_t& bits = writable(connection_chunks, i / chunk_size).enable_bits;
+                if(enable)
+                        bits |= uint64_t{1} << (i % chunk_size);
+                else
+                        bits &= ~(uint64_t{1} << (i % chunk_size));
+        }
+
+        // contiguous weights of the connection genes [chunk * chunk_size, min((chunk + 1) * chunk_size, count))
+        // - the writable version copies the chunk first if it's shared
+        std::size_t weight_chunks() const noexcept { return (connection_total + chunk_size - 1) / chunk_size; }
+        const float* weights(const std::size_t chunk) const { return connection_chunks->items.at(chunk)->weights(); }
+        float* writable_weights(const std::size_t chunk) { return writable(connection_chunks, chunk).weights(); }
+
+        // heap memory referenced by the genes, in bytes (including chunks shared with other genes)
+        std::size_t bytes() const noexcept;
+        // heap memory held by these genes alone, i.e. what copying them would not share, in bytes
+        // - read from the reference counts: a statistic, exact only while no other thread copies or drops the genes
+        std::size_t unique_bytes() const noexcept;
+
+    private:
+        // `capacity` genes in one allocation, the fields one after the other (structure of arrays)
+        // - `shared` is raised once a second list of chunks references the chunk, the chunk is never written again
+        struct NodeChunk{
+                explicit NodeChunk(const std::size_t capacity);
+                // copy of another chunk with another capacity (the genes that fit are kept), not shared
+                NodeChunk(const NodeChunk& other, const std::size_t capacity);
+
+                static constexpr std::size_t gene_bytes = sizeof(uint32_t) + sizeof(float) + 2 * sizeof(uint8_t);
+                uint32_t* numbers() const noexcept { return reinterpret_cast<uint32_t*>(data.get()); }
+                float* biases() const noexcept { return reinterpret_cast<float*>(data.get() + 4 * capacity); }
+                uint8_t* types() const noexcept { return reinterpret_cast<uint8_t*>(data.get() + 8 * capacity); }
+                uint8_t* activations() const noexcept { return reinterpret_cast<uint8_t*>(data.get() + 9 * capacity); }
+                std::size_t bytes() const noexcept { return sizeof(NodeChunk) + gene_bytes * capacity; }
+
+                const std::size_t capacity;
+                const std::unique_ptr<std::byte[]> data;
+                std::atomic<bool> shared{false};
+        };
+
+        struct ConnectionChunk{
+                explicit ConnectionChunk(const std::size_t capacity);
+                // copy of another chunk with another capacity (the genes that fit are kept), not shared
+                ConnectionChunk(const ConnectionChunk& other, const std::size_t capacity);
+
+                static constexpr std::size_t gene_bytes = 3 * sizeof(uint32_t) + sizeof(float);
+                uint32_t* ins() const noexcept { return reinterpret_cast<uint32_t*>(data.get()); }
+                uint32_t* outs() const noexcept { return reinterpret_cast<uint32_t*>(data.get() + 4 * capacity); }
+                uint32_t* innovs() const noexcept { return reinterpret_cast<uint32_t*>(data.get() + 8 * capacity); }
+                float* weights() const noexcept { return reinterpret_cast<float*>(data.get() + 12 * capacity); }
+                std::size_t bytes() const noexcept { return sizeof(ConnectionChunk) + gene_bytes * capacity; }
+
+                const std::size_t capacity;
+                const std::unique_ptr<std::byte[]> data;
+                uint64_t enable_bits = 0;
+                std::atomic<bool> shared{false};
+        };
+
+        // list of chunks, `shared` once a second CompactGenes references it; the chunks are only ever changed
+        // through writable(), i.e. while neither the list nor the chunk is shared
+        template<typename Chunk>
+        struct Chunks{
+                Chunks() = default;
+                // the copy references the same chunks, they are flagged as shared
+                Chunks(const Chunks& other) : items{other.items}{
+                        for(auto& chunk : items)
+                                chunk->shared.store(true, std::memory_order_release);
+                }
+
+                std::vector<std::shared_ptr<Chunk>> items;
+                std::atomic<bool> shared{false};
+        };
+
+        const NodeChunk& node_at(const std::size_t i) const { return *node_chunks->items[i / chunk_size]; }
+        const ConnectionChunk& connection_at(const std::size_t i) const { return *connection_chunks->items[i / chunk_size]; }
+
+        // another reference to a list of chunks, flagged as shared
+        template<typename Chunk>
+        static std::shared_ptr<Chunks<Chunk>> share(const std::shared_ptr<Chunks<Chunk>>& chunks) noexcept{
+                if(chunks)
+                        chunks->shared.store(true, std::memory_order_release);
+                return chunks;
+        }
+
+        // the list of chunks, ready to be changed (copied first if it's shared)
+        template<typename Chunk>
+        static Chunks<Chunk>& writable_list(std::shared_ptr<Chunks<Chunk>>& chunks){
+                if(!chunks)
+                        chunks = std::make_shared<Chunks<Chunk>>();
+                else if(chunks->shared.load(std::memory_order_acquire))
+                        chunks = std::make_shared<Chunks<Chunk>>(*chunks);
+                return *chunks;
+        }
+
+        // a chunk, ready to be changed (the list of chunks and the chunk are copied first if they are shared)
+        template<typename Chunk>
+        static Chunk& writable(std::shared_ptr<Chunks<Chunk>>& chunks, const std::size_t chunk){
+                std::shared_ptr<Chunk>& ptr = writable_list(chunks).items.at(chunk);
+                if(ptr->shared.load(std::memory_order_acquire))
+                        ptr = std::make_shared<Chunk>(*ptr, ptr->capacity);
+                return *ptr;
+        }
+
+        // the chunk that gene number `count` goes to, ready to be changed: a new chunk after a full one, the last
+        // chunk with twice the capacity when it's out of room
+        template<typename Chunk>
+        static Chunk& append(std::shared_ptr<Chunks<Chunk>>& chunks, const std::size_t count){
+                Chunks<Chunk>& list = writable_list(chunks);
+                if(count % chunk_size == 0){
+                        list.items.push_back(std::make_shared<Chunk>(min_chunk_capacity));
+                        return *list.items.back();
+                }
+                std::shared_ptr<Chunk>& last = list.items.back();
+                if(count % chunk_size == last->capacity)
+                        last = std::make_shared<Chunk>(*last, 2 * last->capacity);
+                return writable(chunks, list.items.size() - 1);
+        }
+
+        std::shared_ptr<Chunks<NodeChunk>> node_chunks;
+        std::shared_ptr<Chunks<ConnectionChunk>> connection_chunks;
+        std::size_t node_total = 0, connection_total = 0;
+};
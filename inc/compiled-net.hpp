@@ -0,0 +1,59 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "gene.hpp"
+#include "compact-gene.hpp"
+
+using std::uint64_t;
+using std::uint32_t;
+
+// flat, layered form of a genotype's enabled connections, ready to be propogated
+// - every node lives in a slot, slots are ordered by topological layer, then by activation function, then by
+//   node number
+// - layer 0 holds the sensor nodes, a node's layer is 1 + the deepest layer among it's inputs
+// - edges are grouped by the layer of their out node, so a layer can be computed in one sweep
+// - within a layer the nodes sharing an activation function form a contiguous group, each group is activated by
+//   one branch-free loop
+class CompiledNet{
+    public:
+        // float unless the build asks for the long double kernels (NEAT_LONG_DOUBLE_KERNEL)
+#ifdef NEAT_LONG_DOUBLE_KERNEL
+        using Scalar = long double;
+#else
+        using Scalar = float;
+#endif
+        using DataPkt = std::map<uint64_t, long double>;
+
+        // compile the node genes and connection genes - throws if the enabled connections form a cycle
+        explicit CompiledNet(const CompactGenes& genes);
+
+        // using the input data (one entry per sensor node), propogate the network and compute for the output
+        DataPkt evaluate(const DataPkt& pkt) const;
+
+    public: // raw layout, used by the batched kernels
+        // number of layers (including the sensor layer) and slots
+        std::size_t layers() const noexcept { return layer_begin.size() - 1; }
+        std::size_t slots() const noexcept { return node_ids.size(); }
+        std::size_t sensors() const noexcept { return layer_begin.at(1); }
+
+        // the node number held by each slot
+        std::vector<uint64_t> node_ids;
+        // slots of layer l are [layer_begin[l], layer_begin[l + 1])
+        std::vector<uint32_t> layer_begin;
+        // edges into layer l are [edge_begin[l], edge_begin[l + 1]), stored as structure of arrays
+        std::vector<uint32_t> edge_begin;
+        std::vector<uint32_t> edge_src, edge_dst;
+        std::vector<Scalar> edge_weight;
+        // the bias of each slot (0 for the sensors), the value a node starts accumulating from
+        std::vector<Scalar> bias;
+        // groups of layer l are [layer_group[l], layer_group[l + 1]) (the sensor layer has none),
+        // slots of group g are [group_begin[g], group_begin[g + 1]) and share group_activation[g]
+        std::vector<uint32_t> layer_group;
+        std::vector<uint32_t> group_begin;
+        std::vector<Activation> group_activation;
+        // slots of the output nodes, ordered by node number
+        std::vector<uint32_t> output_slots;
+};
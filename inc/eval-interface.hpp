@@ -1,7 +1,12 @@
 #pragma once
 
 #include <map>
+#include <limits>
+#include <vector>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <algorithm>
 #include "genotype.hpp"
 
 using std::uint64_t;
@@ -17,6 +22,50 @@ using std::uint64_t;
  * 3. Instantiate the class and use it
  */
 
+// limits of a single evaluation (episode)
+struct EvalBudget{
+        // max number of game ticks, 0 means unlimited
+        uint64_t max_ticks = 0;
+        // max wall time, 0 means unlimited
+        std::chrono::nanoseconds max_time{0};
+        // racing: abort as soon as the genotype provably cannot reach this score anymore
+        // (needs a finite number of remaining ticks and a finite EvalInterface::max_reward)
+        long double threshold = -std::numeric_limits<long double>::infinity();
+};
+
+// how an evaluation ended
+enum struct EvalStatus{
+        finished,       // acturate returned false
+        tick_limit,     // ran out of ticks (per episode cap, or the shared TickPool is empty)
+        time_limit,     // ran out of wall time
+        raced_out       // could not reach EvalBudget::threshold anymore
+};
+
+// shared budget of game ticks for a batch of evaluations (thread safe)
+// - episodes draw their ticks in small chunks and give back whatever they did not use,
+//   so the ticks saved by short or aborted episodes go to the ones that still need them
+class TickPool{
+    public:
+        explicit TickPool(const uint64_t ticks) noexcept : left{ticks} {}
+
+        // take up to n ticks from the pool, return how many were granted
+        uint64_t reserve(const uint64_t n) noexcept {
+                uint64_t have = left.load();
+                while(!left.compare_exchange_weak(have, have - std::min(have, n)))
+                        ;
+                return std::min(have, n);
+        }
+
+        // give unused ticks back to the pool
+        void refund(const uint64_t n) noexcept { left += n; }
+
+        // number of ticks left in the pool
+        uint64_t remaining() const noexcept { return left.load(); }
+
+    private:
+        std::atomic<uint64_t> left;
+};
+
 class EvalInterface{
     public:
         using DataPkt = std::map<uint64_t,long double>;
@@ -38,16 +87,73 @@ class EvalInterface{
          *   ` update the genotype's score using the user-defined score update policy
          */
         inline void loop(Genotype& geno){
+                loop(geno, EvalBudget{});
+        }
+
+        /**
+         * budgeted game loop:
+         * - same as above, but the game is cut short once the budget runs out
+         * - ticks are drawn from the pool (if any) on top of the per episode cap
+         * - racing: after every tick, the best reachable score is the current score plus max_reward() for
+         *   every tick left under the per episode cap; once that falls below the threshold the evaluation is
+         *   aborted (the pool does not tighten the bound: the ticks other episodes hold may still be refunded)
+         */
+        inline EvalStatus loop(Genotype& geno, const EvalBudget& budget, TickPool* pool = nullptr){
+                using Clock = std::chrono::steady_clock;
+                constexpr uint64_t chunk = 64; // ticks drawn from the pool at a time
+                constexpr uint64_t unlimited = std::numeric_limits<uint64_t>::max();
+                const auto deadline = Clock::now() + budget.max_time;
+                const long double reward = max_reward();
+
                 // initialize the genotype and the necessary game variables
                 initialize(geno);
 
+                uint64_t ticks = 0, held = 0;
+                EvalStatus status = EvalStatus::finished;
                 bool cont = true;
                 do{
+                        const uint64_t cap = budget.max_ticks ? budget.max_ticks - ticks : unlimited;
+                        if(cap == 0){
+                                status = EvalStatus::tick_limit;
+                                break;
+                        }
+                        if(pool && held == 0 && (held = pool->reserve(std::min(chunk, cap))) == 0){
+                                status = EvalStatus::tick_limit;
+                                break;
+                        }
+
                         // check if the game has end or not
                         cont = acturate(geno.evaluate(collect()));
                         // update the geno's score (fitness)
                         geno.fitness = upd_score(geno.fitness);
+                        ++ticks;
+                        if(pool)
+                                --held;
+
+                        if(!cont)
+                                break;
+                        if(budget.max_time.count() && Clock::now() >= deadline){
+                                status = EvalStatus::time_limit;
+                                break;
+                        }
+
+                        // upper bound of the final score
+                        const uint64_t remaining = budget.max_ticks ? budget.max_ticks - ticks : unlimited;
+                        long double bound = geno.fitness;
+                        if(reward > 0 && remaining > 0)
+                                bound = remaining == unlimited ? std::numeric_limits<long double>::infinity()
+                                                               : bound + reward * remaining;
+                        if(bound < budget.threshold){
+                                status = EvalStatus::raced_out;
+                                break;
+                        }
                 }while(cont);
+
+                if(pool)
+                        pool->refund(held);
+                // characterize what the genotype did (novelty search)
+                geno.behaviour = behaviour();
+                return status;
         }
 
     private:
@@ -82,4 +188,19 @@ class EvalInterface{
          * - must implement in derived class (your own score update policy)
          */
         virtual long double upd_score(const long double old_score) const = 0;
+
+        /**
+         * max reward per tick:
+         * - upper bound of the score a genotype can gain in a single game tick (used for racing)
+         * - can choose to implement in derived class, the default (infinity) disables racing
+         */
+        virtual long double max_reward() const { return std::numeric_limits<long double>::infinity(); }
+
+        /**
+         * behaviour descriptor:
+         * - characterize what the genotype did during the game (final position, visited cells, etc.)
+         * - called once the game has ended, stored in Genotype::behaviour
+         * - can choose to implement in derived class, the default reports no behaviour
+         */
+        virtual std::vector<long double> behaviour() const { return {}; }
 };
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <queue>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <cstddef>
+#include <exception>
+#include <coroutine>
+#include <condition_variable>
+#include "genotype.hpp"
+#include "co-eval-interface.hpp"
+
+// multiplex many CoEvalInterface episodes over a small pool of worker threads
+// - a worker never blocks on an episode: suspended episodes (delays, pending propogations) cost only their frame
+// - network propogations requested by the episodes are queued (first come first served) and taken out in
+//   batches, one lock round trip per batch; each one runs on it's genotype's cached CompiledNet
+// - a propogation that fails (e.g. a genotype that does not compile) throws inside the episode that asked for it
+class EvalScheduler{
+    public:
+        using DataPkt = CoEvalInterface::DataPkt;
+        using Clock = std::chrono::steady_clock;
+
+        // specify the number of worker threads and the max number of propogations evaluated in one batch
+        [[nodiscard]] explicit EvalScheduler(const std::size_t threads, const std::size_t batch_size = 64);
+        // destroy the episodes that have been spawned but never run
+        ~EvalScheduler();
+
+        EvalScheduler(const EvalScheduler&) = delete;
+        EvalScheduler& operator=(const EvalScheduler&) = delete;
+
+        // register an episode: env drives geno until acturate returns false
+        // - env must outlive run(), use one env per episode
+        // - a genotype must not be shared by two episodes that run at the same time
+        void spawn(CoEvalInterface& env, Genotype& geno);
+
+        // run all the spawned episodes to completion on the thread pool
+        // - the first exception thrown by an episode is rethrown once every episode has ended
+        void run();
+
+        // awaitable handing a network propogation to the scheduler - resumes with the output DataPkt
+        auto evaluate(Genotype& geno, const DataPkt& pkt){
+                struct Awaiter{
+                        EvalScheduler& sched;
+                        Genotype& geno;
+                        const DataPkt& pkt;
+                        DataPkt out;
+                        std::exception_ptr error;
+
+                        bool await_ready() const noexcept { return false; }
+                        void await_suspend(std::coroutine_handle<> h){
+                                sched.submit(EvalRequest{.geno = &geno, .in = &pkt, .out = &out, .error = &error, .handle = h});
+                        }
+                        DataPkt await_resume(){
+                                if(error)
+                                        std::rethrow_exception(error);
+                                return std::move(out);
+                        }
+                };
+                return Awaiter{*this, geno, pkt, {}, nullptr};
+        }
+
+    private:
+        friend struct CoDelay;
+        friend struct CoEpisode::promise_type::FinalAwaiter;
+
+        // a network propogation waiting to be evaluated
+        struct EvalRequest{
+                Genotype* geno;
+                const DataPkt* in;
+                DataPkt* out;
+                std::exception_ptr* error; // set instead of out when the propogation fails
+                std::coroutine_handle<> handle;
+        };
+
+        // a suspended coroutine waiting for its deadline
+        struct Timer{
+                Clock::time_point deadline;
+                std::coroutine_handle<> handle;
+
+                // std::priority_queue is a max heap, the earliest deadline must come out first
+                bool operator<(const Timer& other) const noexcept { return deadline > other.deadline; }
+        };
+
+        // queue a propogation request
+        void submit(const EvalRequest& req);
+
+        // park a coroutine until the deadline
+        void schedule_at(const Clock::time_point deadline, std::coroutine_handle<> h);
+
+        // an episode has ended - record it's exception (if any)
+        void retire(const std::exception_ptr error);
+
+        // evaluate a batch of propogation requests - never throws, failures are reported through the requests
+        static void evaluate_batch(std::vector<EvalRequest>& batch) noexcept;
+
+        // worker thread main loop
+        void work();
+
+        const std::size_t threads, batch_size;
+
+        // everything below is guarded by mtx
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<std::coroutine_handle<>> ready;
+        std::deque<EvalRequest> pending;
+        std::priority_queue<Timer> timers;
+        std::size_t alive = 0; // number of episodes that have not ended yet
+        std::exception_ptr error;
+};
@@ -10,15 +10,32 @@ enum struct NodeType{
         output
 };
 
+// define the node activation functions (sensor nodes are never activated)
+enum struct Activation : std::uint8_t{
+        sigmoid,
+        tanh,
+        relu,
+        gaussian,
+        sin,
+        identity
+};
+
 // define node genes
 struct Node{
         std::uint64_t node_number;
         NodeType node_type;
+        Activation activation = Activation::sigmoid;
+        long double bias = 0;
 
         // return the char representation of node type (when printing the node types)
         static char get_nodetype(const NodeType type) noexcept;
         // from the char representation to node type enum
         static NodeType get_nodetype(const char type) noexcept;
+
+        // return the char representation of an activation function (when printing the node activations)
+        static char get_activation(const Activation activation) noexcept;
+        // from the char representation to activation enum
+        static Activation get_activation(const char activation) noexcept;
 };
 
 // define connection genes
@@ -2,14 +2,17 @@
 
 #include <map>
 #include <set>
+#include <atomic>
 #include <list>
 #include <vector>
 #include <string>
+#include <memory>
 #include <cstdint>
 #include <utility>
 #include <filesystem>
 #include "gene.hpp"
-#include "graph-network.hpp"
+#include "compact-gene.hpp"
+#include "compiled-net.hpp"
 
 // using declarations
 using std::uint64_t;
@@ -26,19 +29,44 @@ class Genotype{
         explicit Genotype(const int inputs, const int outputs);
         // another way to construct a genotype is by reading from a .model file
         explicit Genotype(const std::filesystem::path& model_file);
+        // build a genotype straight from it's genes (used when restoring stored genotypes)
+        explicit Genotype(const NodeList& nodes, const ConnectionList& connections);
+        explicit Genotype(CompactGenes genes);
 
         // using the input data, propogate the network and compute for the output
         DataPkt evaluate(const DataPkt& pkt);
 
+        // get the compiled (flat, layered) network - compiled on first use, dropped by every mutation
+        std::shared_ptr<const CompiledNet> compile();
+
         // randomly mutate the genotype
         void mutate();
 
+        // copy the genes into a new genotype with a fresh id number, no score and no behaviour (used to create offspring)
+        Genotype clone() const;
+
+        // get the unique id number of the genotype
+        uint64_t get_id() const noexcept { return id; }
+
+        // read-only access to the packed genes
+        const CompactGenes& get_genes() const noexcept { return genes; }
+        // unpacked copies of the genes (I/O, debugging)
+        NodeList get_nodes() const { return genes.nodes(); }
+        ConnectionList get_connections() const { return genes.connections(); }
+
+        // NEAT compatibility distance between two genotypes (used for speciation)
+        // - genes are matched by their (in, out) node pair, c1 weights the unmatched genes, c3 the weight differences
+        static long double distance(const Genotype& a, const Genotype& b, const long double c1, const long double c3);
+
     public: // public member variables
         // the score (fitness level) of a genotype
         long double fitness;
+        // behaviour descriptor reported by the last evaluation (used by novelty search), empty if none
+        std::vector<long double> behaviour;
 
     private: // private member function
         friend struct GenotypeProbing; // linking printing utils
+        friend class WeightMutation; // population-wide weight mutation stage
 
         // add random connection mutation - return if the connection is successfully added
         bool add_connection();
@@ -46,19 +74,23 @@ class Genotype{
         // add random node mutation - return if the node is successfully added
         bool add_node();
 
-        // randomly toggle (disable & enable) a connection - always success
+        // randomly toggle (disable & enable) a connection - fails if enabling it would close a cycle
         bool toggle_connection();
 
+        // give a random hidden / output node another activation function - return if a node was changed
+        bool mutate_activation();
+
+        // perturb the bias of a random hidden / output node - return if a node was changed
+        bool mutate_bias();
+
     private: // private member variables
-        // we would prefer using a linked list to store all the node genes and connection genes
-        // linked list support O(1) operations (compared to using vector)
-        NodeList node_genes;
-        ConnectionList connection_genes;
+        // node genes and connection genes, packed (genes are only ever appended or changed in place)
+        CompactGenes genes;
 
-        // graph-based representation of the network
-        GraphNet net;
+        // cached compiled network, nullptr if the genes changed since the last compilation
+        std::shared_ptr<const CompiledNet> phenotype;
 
         // each genotype will receive it's own id number, this is used to differentiate each genes
-        inline static uint64_t id_counter = 0;
+        inline static std::atomic<uint64_t> id_counter = 0;
         uint64_t id;
 };
@@ -1,29 +1,25 @@
 #pragma once
 
-#include <map>
 #include <set>
-#include <list>
-#include <deque>
 #include <vector>
 #include <cstdint>
-#include <type_traits>
-#include "gene.hpp"
+#include "compact-gene.hpp"
 
 // ASSUME ALL GRAPHS ARE DIRECTED!
+// adjacency of the enabled connections of a genotype - it's not stored along with the genes, the structural
+// mutations derive it from the genes when they need it and drop it afterwards
+// - node numbers index the adjacency directly (node numbers are dense, starting from 1), edges are 32 bits,
+//   weights are not kept (nothing reads them)
 class GraphNet{
     public:
-        // map is a set of pairs itself; easier to write, have move functionalities,
-        // and two level indexing makes updating an edge weight O(2logN)
-        using WeightedGraph = std::map<uint64_t, std::map<uint64_t, long double>>;
-        using UnweightedGraph = std::map<uint64_t, std::set<uint64_t>>;
-        using ConnectionList = std::list<Connection>;
+        using Graph = std::vector<std::vector<uint32_t>>;
         using NodeID = const std::uint64_t;
 
-        // construct both graphs from list of connections
-        void construct(const ConnectionList& connections);
+        // construct both graphs from the enabled connection genes
+        explicit GraphNet(const CompactGenes& genes);
 
         // add an edge to both graphs - if edge already exists, return false
-        bool add(NodeID in_node, NodeID out_node, const long double weight);
+        bool add(NodeID in_node, NodeID out_node);
 
         // erase an edge from both graphs - if edge does not exist, return false
         bool erase(NodeID in_node, NodeID out_node);
@@ -34,51 +30,24 @@ class GraphNet{
         // find all children that is reachable from the target node via at least one path
         std::set<uint64_t> children(NodeID node) const;
 
-        // return the topological ordering of the WEIGHTED graph
+        // return the topological ordering of the graph
         std::vector<uint64_t> topsort() const;
 
-        // check if there exists a cycle in the WEIGHTED graph
+        // check if there exists a cycle in the graph
         bool has_cycle() const;
 
         // check if an edge exists
         bool exist(NodeID in_node, NodeID out_node) const;
-        
+
     private:
         // helper method to find reachable nodes in either graphs
-        template<typename G>
-        inline auto find_reachable(NodeID node, const G& g) const -> std::set<uint64_t> {
-                std::set<uint64_t> reachable;
-                std::deque<uint64_t> q;
-                q.push_back(node);
-
-                while(!q.empty()){
-                        std::uint64_t node = q.front();
-                        q.pop_front();
-                        if(reachable.count(node))
-                                continue;
-                        reachable.insert(node);
+        std::set<uint64_t> find_reachable(NodeID node, const Graph& g) const;
 
-                        // add adjcent nodes
-                        if(!g.count(node))
-                                continue;
-                        for(auto adj : g.at(node)){
-                                q.push_back([]<typename T>(const T& v){
-                                        if constexpr(std::is_convertible_v<T, GraphNet::UnweightedGraph::mapped_type::value_type>)
-                                                return v;
-                                        else if constexpr(std::is_convertible_v<T, GraphNet::WeightedGraph::mapped_type::value_type>)
-                                                return v.first;
-                                        else
-                                                ;
-                                }(adj));
-                        }
-                }
+        // make room for the node numbers up to and including node
+        void reserve(NodeID node);
 
-                return reachable;
-        }
-        
-        // adjacency list strcture of the network
-        WeightedGraph graph;
-        UnweightedGraph Tgraph;
+        // adjacency list strcture of the network (graph) and of it's transpose (Tgraph), indexed by node number
+        Graph graph, Tgraph;
 
         // keep track of the number of nodes in the network
         uint64_t node_count = 0;
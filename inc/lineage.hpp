@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <variant>
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <unordered_map>
+#include "gene.hpp"
+#include "genotype.hpp"
+#include "compact-gene.hpp"
+
+using std::uint64_t;
+using std::uint32_t;
+
+// history of every genotype, stored as it's parent(s) plus the mutations that turned the parent into it
+// - a child normally differs from it's first parent by a handful of mutations, so only those are stored
+// - every `interval` steps down a line of descent (and for founders) the full genes are kept as a keyframe,
+//   so rebuilding a genotype never replays more than `interval` sets of mutations; a child whose mutations
+//   would take more room than it's genes (e.g. most weights changed) is stored as a keyframe too
+// - .lineage files are compact and deterministic: variable length integers, float weights and biases (as in
+//   CompactGenes), scores as doubles, records ordered by id number, little endian
+class LineageStore{
+    public:
+        // keep a full keyframe every `interval` generations of a lineage
+        explicit LineageStore(const uint32_t interval = 16);
+        // load a store written by LineageStore::save
+        explicit LineageStore(const std::filesystem::path& lineage_file);
+
+        // record a genotype (and it's score) under it's id number
+        // - the mutations are taken against the first parent
+        // - founders, genotypes whose first parent was never recorded, and genotypes whose genes cannot be
+        //   derived from the first parent are stored as keyframes
+        void record(const Genotype& geno, const std::vector<uint64_t>& parents);
+
+        // rebuild a recorded genotype (the copy receives a new id number, the score is restored)
+        Genotype reconstruct(const uint64_t id) const;
+
+        // parents of a recorded genotype, and all of it's ancestors (closest first)
+        const std::vector<uint64_t>& parents(const uint64_t id) const;
+        std::vector<uint64_t> ancestors(const uint64_t id) const;
+
+        // check if a genotype has been recorded, the number of recorded genotypes and of keyframes among them
+        bool contains(const uint64_t id) const { return records.count(id); }
+        std::size_t size() const noexcept { return records.size(); }
+        std::size_t keyframes() const noexcept;
+
+        // write the whole store to a binary .lineage file
+        void save(const std::filesystem::path& lineage_file) const;
+
+    private:
+        // the mutations between a parent and it's child, one alternative per kind of mutation
+        struct AddNode{ uint32_t number; NodeType type; Activation activation; float bias; };
+        struct AddConnection{ uint32_t in, out, innov; float weight; bool enable; };
+        struct Toggle{ uint32_t index; };                               // flip the enable flag of a connection gene
+        struct SetWeight{ uint32_t index; float weight; };              // new weight of a connection gene
+        struct SetNode{ uint32_t index; Activation activation; float bias; }; // new activation and bias of a node gene
+        using Delta = std::variant<AddNode, AddConnection, Toggle, SetWeight, SetNode>;
+
+        struct Record{
+                std::vector<uint64_t> parents;
+                long double fitness;
+                uint32_t depth; // number of delta records between this one and it's keyframe, 0 for keyframes
+                // keyframes hold the full (packed) genes, the other records only the deltas against parents.front()
+                CompactGenes keyframe;
+                std::vector<Delta> deltas;
+        };
+
+        // genes of a recorded genotype
+        CompactGenes rebuild(const uint64_t id) const;
+
+        // compute the deltas from parent genes to child genes - false if the child does not descend from them
+        static bool diff(const CompactGenes& parent, const CompactGenes& child, std::vector<Delta>& deltas);
+
+        // encoded form of a record's genes or deltas (as written in the .lineage files)
+        static void encode(std::string& buf, const CompactGenes& genes);
+        static void encode(std::string& buf, const std::vector<Delta>& deltas);
+
+        const Record& at(const uint64_t id) const;
+
+        uint32_t interval;
+        std::unordered_map<uint64_t, Record> records;
+};
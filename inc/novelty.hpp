@@ -0,0 +1,77 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "genotype.hpp"
+
+using std::int32_t;
+using std::uint32_t;
+
+// vantage-point tree over behaviour descriptors, for k nearest neighbour queries (euclidean distance)
+// - points are inserted into an unindexed tail that is scanned brute force; the tree is rebuilt once the
+//   tail grows past half the indexed points, so inserting stays amortized O(log N)
+// - queries are const and can run from several threads at once
+class VPTree{
+    public:
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        // every point of the tree has `dim` coordinates
+        explicit VPTree(const std::size_t dim);
+
+        // add a point (the tree is rebuilt when the unindexed tail gets too long)
+        void insert(const std::vector<long double>& point);
+
+        // index every point inserted so far
+        void rebuild();
+
+        // distances to the k nearest points, ascending; the point numbered `skip` (insertion order) is ignored
+        std::vector<double> nearest(const std::vector<long double>& query, const std::size_t k,
+                                    const std::size_t skip = npos) const;
+
+        std::size_t size() const noexcept { return count; }
+        std::size_t dimension() const noexcept { return dim; }
+
+    private:
+        struct Node{
+                uint32_t point;
+                double radius;          // median distance from the vantage point to the points below it
+                int32_t inside, outside; // subtrees within / beyond the radius, -1 if none
+        };
+
+        // build the subtree over ids[begin, end), return it's root
+        int32_t build(std::vector<uint32_t>& ids, const std::size_t begin, const std::size_t end);
+
+        // distance between a query and a stored point
+        double distance(const double* query, const uint32_t point) const;
+
+        std::size_t dim;
+        std::vector<double> points; // flat, dim values per point
+        std::size_t count = 0, indexed = 0;
+        std::vector<Node> nodes;
+        int32_t root = -1;
+};
+
+// novelty search: the score of a genotype is how different it's behaviour is from what has been seen so far
+// - novelty = mean distance to the k nearest behaviours among the current population and the archive
+// - genotypes more novel than the threshold are added to the archive
+// - the queries of a population run in parallel
+class NoveltySearch{
+    public:
+        // k nearest neighbours, archive threshold, number of query threads
+        explicit NoveltySearch(const std::size_t k, const long double threshold, const std::size_t threads = 1);
+
+        // replace the fitness of every genotype by it's novelty, then update the archive
+        // - every genotype must carry a behaviour descriptor of the same dimension (as the archive, once it holds
+        //   any), otherwise throws std::invalid_argument before any score is changed
+        void assign(const std::vector<Genotype*>& population);
+
+        // number of archived behaviours
+        std::size_t archive_size() const noexcept { return archive.size(); }
+
+    private:
+        const std::size_t k, threads;
+        const long double threshold;
+        VPTree archive{0};
+};
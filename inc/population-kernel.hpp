@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "compiled-net.hpp"
+
+using std::uint32_t;
+
+// evaluate a whole population of compiled networks over a batch of inputs in one pass
+// - by default every network shares the same sensor rows, so the inputs are loaded only once; otherwise each
+//   network reads it's own block of sensor rows (e.g. one environment lane per network)
+// - the edges of all the networks are packed into one stream grouped by topological layer, and the nodes
+//   of a layer are contiguous rows, so each layer is one accumulation sweep plus one activation sweep per
+//   activation function (the rows of a layer are grouped by activation across all the networks)
+// - values are stored row-major (one row of `batch` values per node), the inner loops run along the batch
+class PopulationKernel{
+    public:
+        using Scalar = CompiledNet::Scalar;
+
+        // pack the compiled networks - all of them must have the same number of sensor nodes
+        explicit PopulationKernel(const std::vector<std::shared_ptr<const CompiledNet>>& nets, const bool shared_inputs = true);
+
+        // propogate every network over the batch
+        // - inputs holds one row of `batch` values per sensor node (sensors ordered by node number); without
+        //   shared inputs, the rows of network 0 come first, then those of network 1, and so on
+        void evaluate(const std::vector<Scalar>& inputs, const std::size_t batch);
+
+        // after evaluate: the row of `batch` values of the k-th output node (by node number) of a network
+        const Scalar* output(const std::size_t net, const std::size_t k) const;
+
+        // number of packed networks, and number of output nodes of a network
+        std::size_t size() const noexcept { return output_begin.size() - 1; }
+        std::size_t outputs(const std::size_t net) const { return output_begin.at(net + 1) - output_begin.at(net); }
+
+    private:
+        std::size_t sensors = 0;
+        // rows of layer l are [layer_begin[l], layer_begin[l + 1]), the rows of layer 0 are the inputs
+        std::vector<uint32_t> layer_begin;
+        // edges into layer l are [edge_begin[l], edge_begin[l + 1])
+        std::vector<uint32_t> edge_begin;
+        std::vector<uint32_t> edge_src, edge_dst;
+        std::vector<Scalar> edge_weight;
+        // bias of each row (0 for the inputs)
+        std::vector<Scalar> bias;
+        // groups of layer l are [layer_group[l], layer_group[l + 1]),
+        // rows of group g are [group_begin[g], group_begin[g + 1]) and share group_activation[g]
+        std::vector<uint32_t> layer_group;
+        std::vector<uint32_t> group_begin;
+        std::vector<Activation> group_activation;
+        // output rows of network n are output_rows[output_begin[n] .. output_begin[n + 1])
+        std::vector<uint32_t> output_begin;
+        std::vector<uint32_t> output_rows;
+
+        // node values of the last evaluation
+        std::vector<Scalar> values;
+        std::size_t batch = 0;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "compiled-net.hpp"
+
+using std::int8_t;
+using std::int32_t;
+using std::uint32_t;
+
+// integer version of a frozen (compiled) network, for high throughput serving
+// - every node value is an int8 with a per node scale, calibrated on sample inputs
+// - edge weights are int8 with a per node scale (the scale of the source value is folded into the weight),
+//   the incoming edges of a node are summed in an int32 accumulator
+// - the bias of a node is the starting value of it's accumulator
+// - the activation is a per node lookup table indexed by the accumulator, over the calibrated range of the
+//   node's input; it directly yields the int8 value of the node, whatever the node's activation function
+class QuantizedNet{
+    public:
+        using Scalar = CompiledNet::Scalar;
+        // one value per sensor node (sensors ordered by node number)
+        using Sample = std::vector<Scalar>;
+
+        // fidelity and size of the quantized network compared to the original one
+        struct Report{
+                std::size_t samples = 0;
+                Scalar max_abs_error = 0, mean_abs_error = 0;
+                std::size_t float_bytes = 0, quantized_bytes = 0;
+        };
+
+        // quantize a compiled network, calibrating the node ranges on the sample inputs
+        explicit QuantizedNet(const CompiledNet& net, const std::vector<Sample>& samples);
+
+        // propogate one sample, return the value of each output node (by node number)
+        std::vector<Scalar> evaluate(const Sample& inputs) const;
+        // same, into `out` - the int8 values and int32 accumulators live in per thread scratch buffers, so once
+        // they and `out` are large enough a call does not allocate
+        void evaluate(const Sample& inputs, std::vector<Scalar>& out) const;
+
+        // compare the outputs with the original network over a set of samples
+        Report compare(const CompiledNet& net, const std::vector<Sample>& samples) const;
+
+    private:
+        static constexpr std::size_t lut_size = 256;
+        // fixed point precision of the accumulator -> lookup table index multiplier: the table index is
+        // (acc - acc_low) * acc_mult >> acc_shift, the shift is chosen per node to keep acc_mult within
+        // [2^(mult_bits - 1), 2^mult_bits], however wide the node's accumulator range is
+        static constexpr int mult_bits = 16;
+        // largest magnitude of a quantized bias, so that bias + incoming products stay within an int32
+        static constexpr int32_t max_acc_bias = 1 << 24;
+
+        // float propogation recording the input (before activation) and value of every node
+        static void trace(const CompiledNet& net, const Sample& inputs, std::vector<Scalar>& input, std::vector<Scalar>& value);
+
+        // quantize a value with the given scale, saturating to [-127, 127]
+        static int8_t quantize(const Scalar x, const Scalar scale);
+
+        std::size_t sensors;
+        std::vector<uint32_t> layer_begin, edge_begin, edge_src, edge_dst;
+        std::vector<int8_t> edge_weight;
+        std::vector<uint32_t> output_slots;
+
+        // per node: scale of the int8 value, quantized bias, lowest accumulator covered by the table,
+        // table index multiplier and shift
+        std::vector<Scalar> value_scale;
+        std::vector<int32_t> acc_bias;
+        std::vector<int32_t> acc_low;
+        std::vector<int32_t> acc_mult;
+        std::vector<int32_t> acc_shift;
+        std::vector<std::array<int8_t, lut_size>> lut;
+};
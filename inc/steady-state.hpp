@@ -0,0 +1,147 @@
+#pragma once
+
+#include <list>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <random>
+#include <vector>
+#include <cstddef>
+#include <optional>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+#include "genotype.hpp"
+#include "eval-interface.hpp"
+#include "weight-mutation.hpp"
+
+/**
+ * Asynchronous (steady-state) evolution, in the spirit of rtNEAT.
+ *
+ * There is no generation barrier: as soon as a worker finishes an evaluation the genotype joins it's
+ * species, the individual with the worst adjusted fitness is retired, and a new offspring is bred and
+ * dispatched right away. Breeding runs on the calling thread while the workers keep evaluating, so
+ * long episodes only hold up their own worker.
+ *
+ * Once the population is full, every evaluation races against the survival threshold: an offspring that
+ * cannot score enough to avoid being retired on arrival is aborted early (see EvalBudget). This is a
+ * heuristic: the threshold is taken when the offspring is dispatched, and the population keeps changing
+ * while it's being evaluated, so it may have survived by the time it would have arrived.
+ *
+ * The breeder draws it's random numbers from engines seeded through rand_select (see rand_seed), so a run
+ * with a single worker is reproducible; with more workers the order in which evaluations finish varies.
+ */
+class SteadyState{
+    public:
+        using EnvFactory = std::function<std::unique_ptr<EvalInterface>()>;
+
+        struct Config{
+                std::size_t capacity = 150;           // population size
+                std::size_t threads = 4;              // evaluation workers
+                std::size_t tournament = 3;           // tournament size when picking a parent inside a species
+                long double compat_threshold = 3.0;   // max compatibility distance to join a species
+                long double c1 = 1.0, c3 = 0.4;       // compatibility distance coefficients
+                EvalBudget budget;                    // per evaluation limits, the racing threshold is set by run()
+                WeightMutation::Config weights;       // weight mutation of every offspring (genome_rate 0 turns it off)
+        };
+
+        // every worker gets it's own environment from the factory (the breeder is seeded from rand_select)
+        explicit SteadyState(const int inputs, const int outputs, const Config& config, EnvFactory factory);
+
+        // keep evolving until `evaluations` more genotypes have been evaluated (and inserted)
+        // - the first exception thrown by an evaluation is rethrown once the workers have stopped
+        void run(const std::size_t evaluations);
+
+        // the fittest genotype in the population, nullptr if the population is empty
+        std::shared_ptr<const Genotype> best() const;
+
+        // number of individuals and species currently alive
+        std::size_t size() const noexcept { return population; }
+        std::size_t species_count() const noexcept { return species.size(); }
+
+        // number of offspring whose mutation failed (e.g. closed a cycle) and was retried
+        std::size_t mutation_failures() const noexcept { return failures; }
+
+    private:
+        friend struct SteadyStateProbing; // unit tests
+
+        // the representative is always a current member, the fittest one (refreshed by insert and retire)
+        struct Species{
+                std::shared_ptr<const Genotype> representative;
+                std::vector<std::shared_ptr<Genotype>> members;
+        };
+
+        // a genotype handed to a worker, with the score it must reach to survive (as of the dispatch)
+        struct Job{
+                std::shared_ptr<Genotype> geno;
+                long double threshold;
+        };
+
+        // a finished evaluation reported by a worker
+        struct Result{
+                std::shared_ptr<Genotype> geno;
+                std::exception_ptr error;
+        };
+
+        // minimal blocking queue between the breeder and the workers
+        template<typename T>
+        class Channel{
+            public:
+                void push(T item){
+                        std::lock_guard<std::mutex> lock(mtx);
+                        items.push_back(std::move(item));
+                        cv.notify_one();
+                }
+                // blocks until an item is available, empty once the channel is closed and drained
+                std::optional<T> pop(){
+                        std::unique_lock<std::mutex> lock(mtx);
+                        cv.wait(lock, [this]{ return !items.empty() || closed; });
+                        if(items.empty())
+                                return std::nullopt;
+                        T item = std::move(items.front());
+                        items.pop_front();
+                        return item;
+                }
+                void close(){
+                        std::lock_guard<std::mutex> lock(mtx);
+                        closed = true;
+                        cv.notify_all();
+                }
+            private:
+                std::mutex mtx;
+                std::condition_variable cv;
+                std::deque<T> items;
+                bool closed = false;
+        };
+
+        // put an evaluated genotype into it's species, retire the worst individual if over capacity
+        void insert(std::shared_ptr<Genotype> geno);
+
+        // retire the individual with the lowest adjusted fitness (fitness shared within it's species)
+        void retire();
+
+        // make the fittest current member the representative of a species (the first one on ties)
+        static void represent(Species& s);
+
+        // score a new genotype must reach so that it's not the one retired when it arrives
+        long double survival_threshold() const;
+
+        // pick a species (proportional to mean fitness) and a parent inside it (tournament), then clone and mutate
+        // (structure, then weights)
+        // - a failed mutation is counted and retried, after 3 failures the offspring is a plain copy of the parent
+        std::shared_ptr<Genotype> breed();
+
+        // worker thread main loop
+        void work(EvalInterface& env, Channel<Job>& dispatch, Channel<Result>& done) const;
+
+        const int inputs, outputs;
+        const Config config;
+        const EnvFactory factory;
+
+        // only touched by the breeder (the thread calling run)
+        std::list<Species> species;
+        std::size_t population = 0;
+        std::size_t failures = 0;
+        std::mt19937_64 rng;
+        WeightMutation weight_mutation;
+};
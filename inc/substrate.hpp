@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "genotype.hpp"
+#include "compiled-net.hpp"
+
+using std::uint32_t;
+
+// HyperNEAT substrate: fixed layers of neurons placed on a plane, whose weights are painted by a CPPN genotype
+// - the CPPN has 4 sensor nodes (x1, y1, x2, y2 in node number order) and it's first output node gives the weight
+// - every node of a layer can connect to every node of the next layer, the CPPN is queried over all these pairs
+//   as one batched evaluation (see PopulationKernel)
+// - weak weights are pruned, the rest is stored as one sparse (CSR) matrix per pair of layers
+class Substrate{
+    public:
+        using Scalar = CompiledNet::Scalar;
+
+        struct Point{
+                Scalar x, y;
+        };
+
+        // layers of node coordinates: the first layer holds the inputs, the last one the outputs
+        explicit Substrate(std::vector<std::vector<Point>> layers);
+
+        // paint the weights with the CPPN
+        // - the CPPN output is mapped to w in [-1, 1] by the activation function of it's output node: sigmoid and
+        //   gaussian (0 ~ 1) are stretched, tanh and sin are taken as they are, relu and identity are clamped
+        // - connections with |w| <= threshold are pruned and the others are rescaled to (0, max_weight] keeping
+        //   their sign
+        void build(Genotype& cppn, const Scalar threshold = 0.2f, const Scalar max_weight = 3.0f);
+
+        // propogate the substrate: one value per input node in, one value per output node out
+        std::vector<Scalar> evaluate(const std::vector<Scalar>& inputs) const;
+
+        // number of connections kept by the last build
+        std::size_t connections() const noexcept;
+
+    private:
+        // sparse matrix in compressed sparse row format, one row per node of the upper layer
+        struct SparseMatrix{
+                std::vector<uint32_t> row_begin;
+                std::vector<uint32_t> column;
+                std::vector<Scalar> weight;
+        };
+
+        // number of CPPN queries evaluated per batch
+        static constexpr std::size_t batch_size = 4096;
+
+        std::vector<std::vector<Point>> layers;
+        // matrices[l] connects layers[l] to layers[l + 1]
+        std::vector<SparseMatrix> matrices;
+};
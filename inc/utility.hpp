@@ -5,9 +5,17 @@
 #include <utility>
 
 using std::int64_t;
+using std::uint64_t;
 
 // utility function to format a proper exception message
 std::string make_errmsg(const std::string& file, const int line, const std::string& msg);
 
+// utility function to seed the random numbers drawn by the calling thread (the other threads seed themselves
+// from the same base when they first draw), so that single threaded runs are reproducible
+void rand_seed(const uint64_t seed);
+
 // utility function to randomly select a number in an inclusive range
 int64_t rand_select(const std::pair<int64_t, int64_t> range);
+
+// utility function to draw a number from a normal distribution
+long double rand_gaussian(const long double mean, const long double stddev);
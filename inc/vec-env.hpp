@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "genotype.hpp"
+#include "compiled-net.hpp"
+#include "population-kernel.hpp"
+
+using std::uint8_t;
+using std::uint64_t;
+
+/**
+ * Vectorized environment (in the style of VecEnv): one object steps `lanes` independent episodes in lockstep.
+ *
+ * - observations come out as a lanes x inputs matrix, actions go in as a lanes x outputs matrix (row-major,
+ *   one row per lane)
+ * - a whole step is a single virtual call, and the matrices are plain arrays: no per episode dispatch and no
+ *   per tick packets
+ * - lanes reset on their own: when a lane's episode ends, the next one starts within the same step, so the
+ *   observation row of a finished lane already belongs to it's next episode
+ *
+ * To implement your own vectorized environment, inheriate this class and implement reset_lanes and step_lanes.
+ */
+class VecEnv{
+    public:
+        using Scalar = CompiledNet::Scalar;
+
+        virtual ~VecEnv() { /* DO NOTHING!~ */ };
+
+        // start a new episode on every lane
+        void reset();
+
+        // apply one row of actions per lane and advance every lane by one tick (finished lanes are reset)
+        void step(const std::vector<Scalar>& actions);
+
+        // lanes x inputs observation matrix
+        const std::vector<Scalar>& observations() const noexcept { return obs; }
+        // reward and end of episode flag of every lane, for the last step
+        const std::vector<Scalar>& rewards() const noexcept { return reward; }
+        const std::vector<uint8_t>& dones() const noexcept { return done; }
+
+        std::size_t lanes() const noexcept { return lane_count; }
+        std::size_t inputs() const noexcept { return input_count; }
+        std::size_t outputs() const noexcept { return output_count; }
+
+    protected:
+        explicit VecEnv(const std::size_t lanes, const std::size_t inputs, const std::size_t outputs);
+
+    private:
+        // start a new episode on every lane whose mask is set, and write it's first observation row
+        virtual void reset_lanes(const uint8_t* mask, Scalar* observations) = 0;
+
+        // advance every lane by one tick: read it's action row, write it's reward, end of episode flag and
+        // next observation row
+        virtual void step_lanes(const Scalar* actions, Scalar* observations, Scalar* rewards, uint8_t* dones) = 0;
+
+        const std::size_t lane_count, input_count, output_count;
+        std::vector<Scalar> obs, reward;
+        std::vector<uint8_t> done;
+};
+
+// evaluate a population on a vectorized environment
+// - every genotype drives lanes / population consecutive lanes (genotype i owns the i-th block)
+// - all the networks are propogated together, one PopulationKernel pass per tick, each network reading the
+//   observations of it's own lanes
+class VecEvaluator{
+    public:
+        using Scalar = CompiledNet::Scalar;
+
+        // pack the population - the genotypes are compiled once and must outlive the evaluator
+        explicit VecEvaluator(const std::vector<Genotype*>& population);
+
+        // run the environment for `ticks` steps from a fresh reset
+        // - the fitness of a genotype becomes the reward collected by it's lanes, divided by it's lane count
+        // - return the number of episodes completed over all the lanes
+        uint64_t run(VecEnv& env, const uint64_t ticks);
+
+    private:
+        // compile every genotype of the population
+        static std::vector<std::shared_ptr<const CompiledNet>> compile(const std::vector<Genotype*>& population);
+
+        std::vector<Genotype*> population;
+        std::size_t sensors;
+        PopulationKernel kernel;
+        // kernel input rows and action matrix, reused across ticks
+        std::vector<Scalar> inputs, actions;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "genotype.hpp"
+
+using std::uint32_t;
+using std::uint64_t;
+
+// bulk random numbers: xoshiro128+ run on `lanes` independent states side by side, so that filling a buffer
+// is one loop the compiler can vectorize (one state per vector lane)
+class BulkRng{
+    public:
+        static constexpr std::size_t lanes = 16;
+
+        // the states are derived from the seed with splitmix64
+        explicit BulkRng(const uint64_t seed);
+
+        // fill out[0, n) with 32 bit random numbers - n must be a multiple of lanes
+        void fill(uint32_t* __restrict__ out, const std::size_t n) noexcept;
+
+    private:
+        std::array<uint32_t, lanes> s0, s1, s2, s3;
+};
+
+// weight mutation, applied as a separate stage after the structural mutations: to a whole population at once,
+// or to each offspring as it's bred
+// - a genotype takes part with probability genome_rate; each of it's weights is then replaced by a fresh
+//   N(0, replace_stddev) weight with probability `replace`, perturbed by N(0, power) noise with probability
+//   `perturb`, or left alone
+// - the weights are walked chunk by chunk (contiguous runs of CompactGenes::chunk_size floats); the random
+//   numbers of a chunk are drawn in bulk, and the decision, noise and update of every weight are one
+//   branch-free loop
+// - the gaussian noise is approximated by the sum of four uniforms (Irwin-Hall, rescaled to unit variance,
+//   tails clipped at +-3.46 standard deviations), which needs no transcendental function
+// - a chunk is only made writable (copied, if shared) when one of it's weights changes, and only the genotypes
+//   whose weights actually changed drop their compiled network
+class WeightMutation{
+    public:
+        struct Config{
+                float genome_rate = 0.8f;       // probability that a genotype's weights are mutated at all
+                float perturb = 0.9f;           // per weight probability of a perturbation
+                float replace = 0.1f;           // per weight probability of a replacement
+                float power = 0.5f;             // standard deviation of the perturbations
+                float replace_stddev = 1.0f;    // standard deviation of the replacement weights
+        };
+
+        // the random numbers are seeded from rand_select, see rand_seed
+        explicit WeightMutation(const Config& config);
+
+        // mutate the weights of the population, return the number of weights changed
+        std::size_t apply(const std::vector<Genotype*>& population);
+        // mutate the weights of one genotype (e.g. an offspring), return the number of weights changed
+        std::size_t apply(Genotype& geno);
+
+    private:
+        // next random number of the genome_rate decisions (drawn in bulk, `lanes` at a time)
+        uint32_t pick() noexcept;
+
+        // mutate the first n weights of a chunk in place, return the number of weights changed
+        std::size_t mutate_chunk(CompactGenes& genes, const std::size_t chunk, const std::size_t n);
+
+        const Config config;
+        BulkRng rng;
+        // random numbers of a chunk: one decision, two for the noise (four 16 bit halves) per weight
+        std::vector<uint32_t> draws;
+        std::array<uint32_t, BulkRng::lanes> picks;
+        std::size_t next_pick = BulkRng::lanes;
+};
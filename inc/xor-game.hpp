@@ -21,7 +21,12 @@ class XorGame : public EvalInterface{
         // increase the score if the output is correct
         virtual long double upd_score(const long double old_score) const override final;
 
+        // every correct output is worth exactly one point
+        virtual long double max_reward() const override final;
+
     private: // private member variables
         const std::uint32_t in_pin;
         mutable DataPkt rand_input;
+        // whether the last output was correct (scored by upd_score)
+        bool correct = false;
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include <cstdint>
+#include "vec-env.hpp"
+
+// vectorized version of XorGame: every lane plays it's own game
+// - each tick a lane sees `in_pin` random bits and must answer their parity (the output fires above 0.5)
+// - a correct answer is worth one point, the episode ends on the first wrong answer or after max_ticks ticks
+class XorVecEnv : public VecEnv{
+    public:
+        // number of lanes, input pins of the XOR gate, and max length of an episode (0 means unlimited)
+        [[nodiscard]] explicit XorVecEnv(const std::size_t lanes, const std::uint32_t in_pin, const std::uint64_t max_ticks = 0);
+
+    private: // private member functions
+        // reset the tick counter of the lanes and draw their first bits
+        virtual void reset_lanes(const uint8_t* mask, Scalar* observations) override final;
+
+        // score the answers, then draw the next bits of the lanes that go on (reset_lanes draws for the ones that are done)
+        virtual void step_lanes(const Scalar* actions, Scalar* observations, Scalar* rewards, uint8_t* dones) override final;
+
+        // fill the observation row of a lane with random bits
+        void draw(Scalar* row);
+
+    private: // private member variables
+        const std::uint32_t in_pin;
+        const std::uint64_t max_ticks;
+        std::vector<std::uint64_t> ticks;
+        std::mt19937_64 rng;
+};
@@ -0,0 +1,52 @@
+#include "activation.hpp"
+#include <cmath>
+
+namespace{
+        // the loop every activation function shares, instantiated once per function so that each one vectorizes
+        template<float (*F)(const float) noexcept>
+        void sweep(float* const values, const std::size_t n) noexcept{
+                for(std::size_t i = 0; i < n; ++i)
+                        values[i] = F(values[i]);
+        }
+}
+
+// apply an activation function to a single value
+float FastActivation::apply(const Activation activation, const float x) noexcept{
+        switch(activation){
+                case Activation::tanh: return tanh(x);
+                case Activation::relu: return relu(x);
+                case Activation::gaussian: return gaussian(x);
+                case Activation::sin: return sin(x);
+                case Activation::identity: return identity(x);
+                default: return sigmoid(x);
+        }
+}
+
+// apply an activation function to n contiguous values, in place (one branch-free loop per function)
+void FastActivation::apply(const Activation activation, float* const values, const std::size_t n) noexcept{
+        switch(activation){
+                case Activation::tanh: sweep<tanh>(values, n); break;
+                case Activation::relu: sweep<relu>(values, n); break;
+                case Activation::gaussian: sweep<gaussian>(values, n); break;
+                case Activation::sin: sweep<sin>(values, n); break;
+                case Activation::identity: break;
+                default: sweep<sigmoid>(values, n); break;
+        }
+}
+
+// exact versions in long double
+long double FastActivation::apply(const Activation activation, const long double x) noexcept{
+        switch(activation){
+                case Activation::tanh: return std::tanh(x);
+                case Activation::relu: return std::max(x, 0.0L);
+                case Activation::gaussian: return std::exp(-x * x);
+                case Activation::sin: return std::sin(x);
+                case Activation::identity: return x;
+                default: return 1 / (1 + std::exp(-4.9L * x));
+        }
+}
+
+void FastActivation::apply(const Activation activation, long double* const values, const std::size_t n) noexcept{
+        for(std::size_t i = 0; i < n; ++i)
+                values[i] = apply(activation, values[i]);
+}
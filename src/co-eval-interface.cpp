@@ -0,0 +1,26 @@
+#include "co-eval-interface.hpp"
+#include "eval-scheduler.hpp"
+
+// game loop (coroutine)
+CoEpisode CoEvalInterface::loop(Genotype& geno){
+        // initialize the genotype and the necessary game variables
+        initialize(geno);
+
+        bool cont = true;
+        do{
+                // sense the environment, propogate the network (batched by the scheduler), then acturate
+                DataPkt in = co_await collect();
+                DataPkt out = co_await sched->evaluate(geno, in);
+                cont = co_await acturate(out);
+                // update the geno's score (fitness)
+                geno.fitness = upd_score(geno.fitness);
+        }while(cont);
+
+        // characterize what the genotype did (novelty search)
+        geno.behaviour = behaviour();
+}
+
+// suspend the episode for a while WITHOUT blocking the worker thread
+CoDelay CoEvalInterface::delay(const std::chrono::nanoseconds duration) const{
+        return CoDelay{.sched = *sched, .deadline = std::chrono::steady_clock::now() + duration};
+}
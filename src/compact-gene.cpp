@@ -0,0 +1,146 @@
+#include "compact-gene.hpp"
+#include "utility.hpp"
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace{
+        // narrow a node number / innovation number to 32 bits
+        uint32_t narrow(const uint64_t value){
+                if(value > std::numeric_limits<uint32_t>::max())
+                        throw std::overflow_error(make_errmsg(__FILE__,__LINE__,"gene number does not fit in 32 bits"));
+                return static_cast<uint32_t>(value);
+        }
+}
+
+// the copy shares the chunks: both sides see them flagged as shared from then on
+CompactGenes::CompactGenes(const CompactGenes& other) noexcept
+        : node_chunks{share(other.node_chunks)}, connection_chunks{share(other.connection_chunks)},
+          node_total{other.node_total}, connection_total{other.connection_total} {}
+
+CompactGenes& CompactGenes::operator=(const CompactGenes& other) noexcept{
+        if(this != &other)
+                *this = CompactGenes(other);
+        return *this;
+}
+
+CompactGenes::NodeChunk::NodeChunk(const std::size_t capacity)
+        : capacity{capacity}, data{new std::byte[gene_bytes * capacity]()} {}
+
+// copy of another chunk with another capacity (the genes that fit are kept), not shared
+CompactGenes::NodeChunk::NodeChunk(const NodeChunk& other, const std::size_t capacity) : NodeChunk(capacity){
+        const std::size_t n = std::min(capacity, other.capacity);
+        std::memcpy(numbers(), other.numbers(), n * sizeof(uint32_t));
+        std::memcpy(biases(), other.biases(), n * sizeof(float));
+        std::memcpy(types(), other.types(), n * sizeof(uint8_t));
+        std::memcpy(activations(), other.activations(), n * sizeof(uint8_t));
+}
+
+CompactGenes::ConnectionChunk::ConnectionChunk(const std::size_t capacity)
+        : capacity{capacity}, data{new std::byte[gene_bytes * capacity]()} {}
+
+CompactGenes::ConnectionChunk::ConnectionChunk(const ConnectionChunk& other, const std::size_t capacity)
+        : ConnectionChunk(capacity){
+        const std::size_t n = std::min(capacity, other.capacity);
+        std::memcpy(ins(), other.ins(), n * sizeof(uint32_t));
+        std::memcpy(outs(), other.outs(), n * sizeof(uint32_t));
+        std::memcpy(innovs(), other.innovs(), n * sizeof(uint32_t));
+        std::memcpy(weights(), other.weights(), n * sizeof(float));
+        enable_bits = other.enable_bits;
+}
+
+// unpack into the plain gene structs
+Node CompactGenes::node(const std::size_t i) const{
+        if(i >= node_total)
+                throw std::out_of_range(make_errmsg(__FILE__,__LINE__,"node gene index out of range"));
+        return Node{
+                .node_number = node_number(i),
+                .node_type = node_type(i),
+                .activation = activation(i),
+                .bias = bias(i)
+        };
+}
+
+Connection CompactGenes::connection(const std::size_t i) const{
+        if(i >= connection_total)
+                throw std::out_of_range(make_errmsg(__FILE__,__LINE__,"connection gene index out of range"));
+        return Connection{
+                .in = in(i), .out = out(i),
+                .weight = weight(i),
+                .enable = enabled(i),
+                .innov = innov(i)
+        };
+}
+
+std::list<Node> CompactGenes::nodes() const{
+        std::list<Node> res;
+        for(std::size_t i = 0; i < node_count(); ++i)
+                res.push_back(node(i));
+        return res;
+}
+
+std::list<Connection> CompactGenes::connections() const{
+        std::list<Connection> res;
+        for(std::size_t i = 0; i < connection_count(); ++i)
+                res.push_back(connection(i));
+        return res;
+}
+
+// append a gene - throws if a node number or innovation number needs more than 32 bits
+void CompactGenes::add_node(const Node& node){
+        const uint32_t number = narrow(node.node_number);
+        NodeChunk& chunk = append(node_chunks, node_total);
+        const std::size_t j = node_total % chunk_size;
+        chunk.numbers()[j] = number;
+        chunk.types()[j] = static_cast<uint8_t>(node.node_type);
+        chunk.activations()[j] = static_cast<uint8_t>(node.activation);
+        chunk.biases()[j] = static_cast<float>(node.bias);
+        ++node_total;
+}
+
+void CompactGenes::add_connection(const Connection& connection){
+        const uint32_t in = narrow(connection.in), out = narrow(connection.out), innov = narrow(connection.innov);
+        ConnectionChunk& chunk = append(connection_chunks, connection_total);
+        const std::size_t j = connection_total % chunk_size;
+        chunk.ins()[j] = in;
+        chunk.outs()[j] = out;
+        chunk.innovs()[j] = innov;
+        chunk.weights()[j] = static_cast<float>(connection.weight);
+        if(connection.enable)
+                chunk.enable_bits |= uint64_t{1} << j;
+        ++connection_total;
+}
+
+// heap memory referenced by the genes, in bytes (including chunks shared with other genes)
+std::size_t CompactGenes::bytes() const noexcept{
+        std::size_t total = 0;
+        if(node_chunks){
+                total += sizeof(*node_chunks) + node_chunks->items.capacity() * sizeof(node_chunks->items.front());
+                for(auto& chunk : node_chunks->items)
+                        total += chunk->bytes();
+        }
+        if(connection_chunks){
+                total += sizeof(*connection_chunks) + connection_chunks->items.capacity() * sizeof(connection_chunks->items.front());
+                for(auto& chunk : connection_chunks->items)
+                        total += chunk->bytes();
+        }
+        return total;
+}
+
+// heap memory held by these genes alone, i.e. what copying them would not share, in bytes
+// - read from the reference counts: a statistic, exact only while no other thread copies or drops the genes
+std::size_t CompactGenes::unique_bytes() const noexcept{
+        std::size_t total = 0;
+        if(node_chunks && node_chunks.use_count() == 1){
+                total += sizeof(*node_chunks) + node_chunks->items.capacity() * sizeof(node_chunks->items.front());
+                for(auto& chunk : node_chunks->items)
+                        total += chunk.use_count() == 1 ? chunk->bytes() : 0;
+        }
+        if(connection_chunks && connection_chunks.use_count() == 1){
+                total += sizeof(*connection_chunks) + connection_chunks->items.capacity() * sizeof(connection_chunks->items.front());
+                for(auto& chunk : connection_chunks->items)
+                        total += chunk.use_count() == 1 ? chunk->bytes() : 0;
+        }
+        return total;
+}
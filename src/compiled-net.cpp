@@ -0,0 +1,138 @@
+#include "compiled-net.hpp"
+#include "activation.hpp"
+#include "utility.hpp"
+#include <deque>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+// compile the node genes and connection genes - throws if the enabled connections form a cycle
+CompiledNet::CompiledNet(const CompactGenes& genes){
+        // index the nodes in gene order
+        const std::size_t nodes = genes.node_count();
+        std::unordered_map<uint64_t, std::size_t> index;
+        for(std::size_t i = 0; i < nodes; ++i)
+                index.emplace(genes.node_number(i), i);
+
+        // adjacency list and in degree of the enabled connections
+        std::vector<std::vector<std::size_t>> adj(nodes);
+        std::vector<std::size_t> indeg(nodes, 0);
+        std::vector<std::size_t> enabled;
+        for(std::size_t c = 0; c < genes.connection_count(); ++c){
+                if(!genes.enabled(c))
+                        continue;
+                if(!index.count(genes.in(c)) || !index.count(genes.out(c)))
+                        throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"connection refers to an unknown node"));
+                if(genes.node_type(index.at(genes.out(c))) == NodeType::sensor)
+                        throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"connection flows into a sensor node"));
+                adj.at(index.at(genes.in(c))).push_back(index.at(genes.out(c)));
+                indeg.at(index.at(genes.out(c)))++;
+                enabled.push_back(c);
+        }
+
+        // assign the layers using Kahn's algorithm: sensors sit in layer 0, any other node in layer 1 at least
+        std::vector<uint32_t> layer(nodes);
+        std::deque<std::size_t> q;
+        for(std::size_t i = 0; i < nodes; ++i){
+                layer.at(i) = genes.node_type(i) == NodeType::sensor ? 0 : 1;
+                if(indeg.at(i) == 0)
+                        q.push_back(i);
+        }
+        std::size_t visited = 0;
+        while(!q.empty()){
+                std::size_t node = q.front();
+                q.pop_front();
+                ++visited;
+                for(auto out : adj.at(node)){
+                        layer.at(out) = std::max(layer.at(out), layer.at(node) + 1);
+                        if(--indeg.at(out) == 0)
+                                q.push_back(out);
+                }
+        }
+        if(visited != nodes)
+                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"graph contains cycle(s)!"));
+
+        // order the slots by layer, then by activation (sensors are never activated), then by node number
+        std::vector<std::size_t> order(nodes);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b){
+                if(layer.at(a) != layer.at(b))
+                        return layer.at(a) < layer.at(b);
+                if(layer.at(a) != 0 && genes.activation(a) != genes.activation(b))
+                        return genes.activation(a) < genes.activation(b);
+                return genes.node_number(a) < genes.node_number(b);
+        });
+
+        const uint32_t depth = nodes == 0 ? 0 : layer.at(order.back());
+        std::vector<uint32_t> slot(nodes);
+        layer_begin.assign(std::max<uint32_t>(depth, 1) + 2, 0);
+        for(std::size_t s = 0; s < order.size(); ++s){
+                slot.at(order.at(s)) = static_cast<uint32_t>(s);
+                node_ids.push_back(genes.node_number(order.at(s)));
+                bias.push_back(layer.at(order.at(s)) == 0 ? 0 : static_cast<Scalar>(genes.bias(order.at(s))));
+                layer_begin.at(layer.at(order.at(s)) + 1)++;
+                if(genes.node_type(order.at(s)) == NodeType::output)
+                        output_slots.push_back(static_cast<uint32_t>(s));
+        }
+        std::partial_sum(layer_begin.begin(), layer_begin.end(), layer_begin.begin());
+
+        // split every layer (but the sensor layer) into runs of nodes sharing an activation function
+        layer_group.assign(2, 0);
+        for(std::size_t l = 1; l + 1 < layer_begin.size(); ++l){
+                for(uint32_t s = layer_begin.at(l); s < layer_begin.at(l + 1); ++s){
+                        const Activation activation = genes.activation(order.at(s));
+                        if(s == layer_begin.at(l) || activation != group_activation.back()){
+                                group_begin.push_back(s);
+                                group_activation.push_back(activation);
+                        }
+                }
+                layer_group.push_back(static_cast<uint32_t>(group_activation.size()));
+        }
+        group_begin.push_back(layer_begin.back());
+
+        // group the edges by the layer of their out node (then by out slot, for locality)
+        std::sort(enabled.begin(), enabled.end(), [&](const std::size_t a, const std::size_t b){
+                uint32_t da = slot.at(index.at(genes.out(a))), db = slot.at(index.at(genes.out(b)));
+                if(da != db)
+                        return da < db;
+                return slot.at(index.at(genes.in(a))) < slot.at(index.at(genes.in(b)));
+        });
+        edge_begin.assign(layer_begin.size(), 0);
+        for(auto c : enabled){
+                edge_src.push_back(slot.at(index.at(genes.in(c))));
+                edge_dst.push_back(slot.at(index.at(genes.out(c))));
+                edge_weight.push_back(static_cast<Scalar>(genes.weight(c)));
+                edge_begin.at(layer.at(index.at(genes.out(c))) + 1)++;
+        }
+        std::partial_sum(edge_begin.begin(), edge_begin.end(), edge_begin.begin());
+
+        // output slots are reported by node number
+        std::sort(output_slots.begin(), output_slots.end(), [this](const uint32_t a, const uint32_t b){
+                return node_ids.at(a) < node_ids.at(b);
+        });
+}
+
+// using the input data (one entry per sensor node), propogate the network and compute for the output
+CompiledNet::DataPkt CompiledNet::evaluate(const DataPkt& pkt) const{
+        std::vector<Scalar> value(bias);
+        for(std::size_t s = 0; s < sensors(); ++s){
+                auto it = pkt.find(node_ids[s]);
+                if(it == pkt.end())
+                        throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"missing input for a sensor node"));
+                value[s] = static_cast<Scalar>(it->second);
+        }
+
+        // sweep the layers: accumulate the incoming edges on top of the biases, then activate group by group
+        for(std::size_t l = 1; l < layers(); ++l){
+                for(uint32_t e = edge_begin[l]; e < edge_begin[l + 1]; ++e)
+                        value[edge_dst[e]] += edge_weight[e] * value[edge_src[e]];
+                for(uint32_t g = layer_group[l]; g < layer_group[l + 1]; ++g)
+                        FastActivation::apply(group_activation[g], value.data() + group_begin[g], group_begin[g + 1] - group_begin[g]);
+        }
+
+        DataPkt out;
+        for(auto s : output_slots)
+                out.emplace(node_ids[s], value[s]);
+        return out;
+}
@@ -0,0 +1,145 @@
+#include "eval-scheduler.hpp"
+#include "utility.hpp"
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+// specify the number of worker threads and the max number of propogations evaluated in one batch
+EvalScheduler::EvalScheduler(const std::size_t threads, const std::size_t batch_size)
+        : threads{threads}, batch_size{batch_size}{
+        if(threads == 0)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"scheduler needs at least 1 thread"));
+        if(batch_size == 0)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"batch size must be at least 1"));
+}
+
+// destroy the episodes that have been spawned but never run
+EvalScheduler::~EvalScheduler(){
+        // only the top-level episode frames can be left in the ready queue when run() was never called
+        for(auto h : ready)
+                h.destroy();
+}
+
+// register an episode: env drives geno until acturate returns false
+void EvalScheduler::spawn(CoEvalInterface& env, Genotype& geno){
+        env.sched = this;
+        auto handle = env.loop(geno).release();
+        handle.promise().sched = this;
+
+        std::lock_guard<std::mutex> lock(mtx);
+        ready.push_back(handle);
+        ++alive;
+}
+
+// run all the spawned episodes to completion on the thread pool
+void EvalScheduler::run(){
+        std::vector<std::thread> workers;
+        for(std::size_t i = 0; i < threads; ++i)
+                workers.emplace_back(&EvalScheduler::work, this);
+        for(auto& worker : workers)
+                worker.join();
+
+        if(error)
+                std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+// queue a propogation request
+void EvalScheduler::submit(const EvalRequest& req){
+        std::lock_guard<std::mutex> lock(mtx);
+        pending.push_back(req);
+        cv.notify_one();
+}
+
+// park a coroutine until the deadline
+void EvalScheduler::schedule_at(const Clock::time_point deadline, std::coroutine_handle<> h){
+        std::lock_guard<std::mutex> lock(mtx);
+        timers.push(Timer{.deadline = deadline, .handle = h});
+        // the new timer might be the earliest one, sleeping workers must recompute their timeout
+        cv.notify_one();
+}
+
+// an episode has ended - record it's exception (if any)
+void EvalScheduler::retire(const std::exception_ptr err){
+        std::lock_guard<std::mutex> lock(mtx);
+        if(err && !error)
+                error = err;
+        if(--alive == 0)
+                cv.notify_all();
+}
+
+// evaluate a batch of propogation requests - never throws, failures are reported through the requests
+void EvalScheduler::evaluate_batch(std::vector<EvalRequest>& batch) noexcept{
+        // every request goes through it's genotype's cached network: packing the networks into a PopulationKernel
+        // for a single row each costs about ten times the propogation itself
+        for(auto& req : batch){
+                try{
+                        *req.out = req.geno->compile()->evaluate(*req.in);
+                }catch(...){
+                        // a request that fails (does not compile, lacks an input) fails alone, the others go on
+                        *req.error = std::current_exception();
+                }
+        }
+}
+
+// worker thread main loop
+void EvalScheduler::work(){
+        std::unique_lock<std::mutex> lock(mtx);
+        while(true){
+                // wake up the coroutines whose deadline has passed
+                const auto now = Clock::now();
+                while(!timers.empty() && timers.top().deadline <= now){
+                        ready.push_back(timers.top().handle);
+                        timers.pop();
+                }
+
+                // flush the propogation requests once a batch is full, or when nothing else can be done meanwhile
+                if(pending.size() >= batch_size || (!pending.empty() && ready.empty())){
+                        // oldest requests first, so that no episode starves
+                        const std::size_t size = std::min(batch_size, pending.size());
+                        std::vector<EvalRequest> batch(pending.begin(), pending.begin() + size);
+                        pending.erase(pending.begin(), pending.begin() + size);
+
+                        lock.unlock();
+                        evaluate_batch(batch);
+                        lock.lock();
+
+                        for(auto& req : batch)
+                                ready.push_back(req.handle);
+                        cv.notify_all();
+                        continue;
+                }
+
+                // resume one ready coroutine, it runs until it suspends again
+                if(!ready.empty()){
+                        auto h = ready.front();
+                        ready.pop_front();
+                        lock.unlock();
+                        h.resume();
+                        lock.lock();
+                        continue;
+                }
+
+                // all the episodes have ended
+                if(alive == 0)
+                        return;
+
+                if(timers.empty())
+                        cv.wait(lock);
+                else
+                        cv.wait_until(lock, timers.top().deadline);
+        }
+}
+
+// report to the scheduler and release the coroutine frame once the episode has ended
+void CoEpisode::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> h) const noexcept{
+        EvalScheduler* sched = h.promise().sched;
+        std::exception_ptr error = h.promise().error;
+        // the frame is suspended at this point, it's safe to destroy it from here
+        h.destroy();
+        sched->retire(error);
+}
+
+// suspend an episode until the deadline
+void CoDelay::await_suspend(std::coroutine_handle<> h) const{
+        sched.schedule_at(deadline, h);
+}
@@ -17,6 +17,30 @@ NodeType Node::get_nodetype(const char type) noexcept{
         return NodeType::sensor;
 }
 
+// return the char representation of an activation function (when printing the node activations)
+char Node::get_activation(const Activation activation) noexcept{
+        switch(activation){
+                case Activation::tanh: return 'T';
+                case Activation::relu: return 'R';
+                case Activation::gaussian: return 'G';
+                case Activation::sin: return 'N';
+                case Activation::identity: return 'I';
+                default: return 'S';
+        }
+}
+
+// from the char representation to activation enum
+Activation Node::get_activation(const char activation) noexcept{
+        switch(activation){
+                case 'T': return Activation::tanh;
+                case 'R': return Activation::relu;
+                case 'G': return Activation::gaussian;
+                case 'N': return Activation::sin;
+                case 'I': return Activation::identity;
+                default: return Activation::sigmoid;
+        }
+}
+
 // return the string representation of each connection (when printing connections)
 std::string Connection::make_connect(const Connection& connect){
         std::ostringstream connection;
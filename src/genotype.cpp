@@ -1,15 +1,16 @@
 #include "genotype.hpp"
 #include "utility.hpp"
 #include "prob.hpp"
+#include "graph-network.hpp"
 #include <fstream>
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
 #include <vector>
-#include <cassert>
 #include <limits>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 
 // this constructor creates a network with no hidden nodes
 // inputs and outputs forms a fully connected graph, each edge receives a weight of 1;
@@ -20,14 +21,14 @@ Genotype::Genotype(const int inputs, const int outputs){
         // create all the nodes
         using std::uint64_t;
         for(uint64_t i = 1; i <= inputs; ++i)
-                node_genes.push_back(Node{.node_number = i, .node_type = NodeType::sensor});
+                genes.add_node(Node{.node_number = i, .node_type = NodeType::sensor});
         for(uint64_t i = inputs + 1; i <= inputs + outputs; ++i)
-                node_genes.push_back(Node{.node_number = i, .node_type = NodeType::output});
+                genes.add_node(Node{.node_number = i, .node_type = NodeType::output});
         
         // create all the edges
         for(uint64_t i = 1; i <= inputs; ++i){
                 for(uint64_t o = inputs + 1; o <= inputs + outputs; ++o){
-                        connection_genes.push_back(Connection{
+                        genes.add_connection(Connection{
                                 .in = i, .out = o, .weight = 1,
                                 .enable = true,
                                 /**
@@ -38,9 +39,6 @@ Genotype::Genotype(const int inputs, const int outputs){
                         });
                 }
         }
-
-        // construct graph representation of the initial network
-        net.construct(connection_genes);
 }
 
 // another way to construct a genotype is by reading from a .model file
@@ -73,7 +71,7 @@ Genotype::Genotype(const std::filesystem::path& model_file){
         // now using node id and node type create the node gene list
         for(int i = 0; i < size; ++i){
                 NodeType t = Node::get_nodetype(node_types.at(i));
-                node_genes.push_back(Node{.node_number = node_ids.at(i), .node_type = t});
+                genes.add_node(Node{.node_number = node_ids.at(i), .node_type = t});
         }
 
         infile >> size; // read the number of connections
@@ -83,7 +81,7 @@ Genotype::Genotype(const std::filesystem::path& model_file){
 
         for(int i = 0; i < size; ++i){
                 infile >> in >> out >> weight >> enable >> innov;
-                connection_genes.push_back(Connection{
+                genes.add_connection(Connection{
                         .in = in,
                         .out = out,
                         .weight = weight,
@@ -92,18 +90,40 @@ Genotype::Genotype(const std::filesystem::path& model_file){
                 });
         }
 
-        // construct graph representation of the initial network
-        net.construct(connection_genes);
+        // optional trailing section: activation function and bias of every node (older files lack it)
+        if(infile >> size){
+                if(size != genes.node_count())
+                        throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"node activations do not match the node genes"));
+                for(std::size_t i = 0; i < size; ++i)
+                        infile >> type, genes.set_activation(i, Node::get_activation(type));
+                long double bias;
+                for(std::size_t i = 0; i < size; ++i)
+                        infile >> bias, genes.set_bias(i, static_cast<float>(bias));
+                if(!infile)
+                        throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"truncated .model file"));
+        }
+}
+
+// build a genotype straight from it's genes (used when restoring stored genotypes)
+Genotype::Genotype(const NodeList& nodes, const ConnectionList& connections)
+        : Genotype(CompactGenes(nodes, connections)){
+}
+
+Genotype::Genotype(CompactGenes genes) : genes{std::move(genes)}{
+        // get a new id number
+        id = ++id_counter;
 }
 
 // using the input data, propogate the network and compute for the output
 Genotype::DataPkt Genotype::evaluate(const Genotype::DataPkt& pkt){
-        /**
-         * FIXME: FILL ME UP PLS!
-         * FIXME: return a dummy value for now...
-         */
+        return compile()->evaluate(pkt);
+}
 
-        return {{1,1}}; // hard-coded for the purpose of testing XorGame class
+// get the compiled (flat, layered) network - compiled on first use, dropped by every mutation
+std::shared_ptr<const CompiledNet> Genotype::compile(){
+        if(!phenotype)
+                phenotype = std::make_shared<const CompiledNet>(genes);
+        return phenotype;
 }
 
 // randomly mutate the genotype
@@ -139,6 +159,43 @@ void Genotype::mutate(){
         toggle_connection();
         toggle_connection();
         toggle_connection();
+        mutate_activation();
+        mutate_bias();
+        mutate_bias();
+}
+
+// copy the genes into a new genotype with a fresh id number, no score and no behaviour (used to create offspring)
+Genotype Genotype::clone() const{
+        Genotype child(*this);
+        child.id = ++id_counter;
+        child.fitness = 0;
+        child.behaviour.clear();
+        return child;
+}
+
+// NEAT compatibility distance between two genotypes (used for speciation)
+long double Genotype::distance(const Genotype& a, const Genotype& b, const long double c1, const long double c3){
+        /**
+         * FIXME: innovation numbers are still placeholders, so genes are matched by their (in, out) node pair
+         * FIXME: this also means excess and disjoint genes cannot be told apart, both are weighted by c1
+         */
+        std::map<std::pair<uint32_t, uint32_t>, float> weights;
+        for(std::size_t i = 0; i < a.genes.connection_count(); ++i)
+                weights.emplace(std::make_pair(a.genes.in(i), a.genes.out(i)), a.genes.weight(i));
+
+        std::size_t matching = 0;
+        long double weight_diff = 0;
+        for(std::size_t i = 0; i < b.genes.connection_count(); ++i){
+                auto it = weights.find(std::make_pair(b.genes.in(i), b.genes.out(i)));
+                if(it == weights.end())
+                        continue;
+                ++matching;
+                weight_diff += std::abs(it->second - b.genes.weight(i));
+        }
+
+        const std::size_t unmatched = a.genes.connection_count() + b.genes.connection_count() - 2 * matching;
+        const long double n = std::max<std::size_t>({a.genes.connection_count(), b.genes.connection_count(), 1});
+        return c1 * unmatched / n + (matching ? c3 * weight_diff / matching : 0);
 }
 
 // add random connection mutation - return if the connection is successfully added
@@ -152,26 +209,30 @@ bool Genotype::add_connection(){
          */
 
         // if no hidden nodes, then the graph is already fully connected, no connections can be added
-        bool has_hidden = std::any_of(node_genes.begin(), node_genes.end(),
-                [this](const Node& node){ return node.node_type == NodeType::hidden;});
+        bool has_hidden = false;
+        for(std::size_t i = 0; i < genes.node_count(); ++i)
+                has_hidden |= genes.node_type(i) == NodeType::hidden;
         if(!has_hidden)
                 return false;
 
         auto generate_in = [this](){
                 std::vector<uint64_t> can;
-                for(auto node : node_genes)
-                        if(node.node_type != NodeType::output)
-                                can.push_back(node.node_number);
+                for(std::size_t i = 0; i < genes.node_count(); ++i)
+                        if(genes.node_type(i) != NodeType::output)
+                                can.push_back(genes.node_number(i));
                 // randomly select one candidate
                 return can.at(rand_select({0, can.size() - 1}));
         };
 
-        auto generate_out = [this](const uint64_t in_node){
+        // graph representation of the network, derived from the genes
+        GraphNet net(genes);
+
+        auto generate_out = [this, &net](const uint64_t in_node){
                 std::set<uint64_t> reachable = net.ancestors(in_node);
                 std::vector<uint64_t> can;
-                for(auto node : node_genes)
-                        if(node.node_type != NodeType::sensor && !reachable.count(node.node_number))
-                                can.push_back(node.node_number);
+                for(std::size_t i = 0; i < genes.node_count(); ++i)
+                        if(genes.node_type(i) != NodeType::sensor && !reachable.count(genes.node_number(i)))
+                                can.push_back(genes.node_number(i));
                 // randomly select one candidate
                 return can.at(rand_select({0, can.size() - 1}));
         };
@@ -182,12 +243,12 @@ bool Genotype::add_connection(){
         // check if the connection already exists
         if(net.exist(in_node, out_node)) // fast method - check for enabled connections
                 return false;
-        for(auto& connection : connection_genes) // slow method - check all connections, including the disabled ones
-                if(in_node == connection.in && out_node == connection.out)
+        for(std::size_t i = 0; i < genes.connection_count(); ++i) // slow method - check all connections, including the disabled ones
+                if(in_node == genes.in(i) && out_node == genes.out(i))
                         return false;
         
         // add the new connection
-        connection_genes.push_back(Connection{
+        genes.add_connection(Connection{
                 .in = in_node, .out = out_node, .weight = 1,
                 .enable = true,
                 /**
@@ -195,7 +256,8 @@ bool Genotype::add_connection(){
                  */
                 .innov = 1
         });
-        net.add(in_node, out_node, 1);
+        net.add(in_node, out_node);
+        phenotype.reset();
 
         // after adding the new connection, validate the new connection does not introduce a cycle
         if(net.has_cycle())
@@ -207,27 +269,26 @@ bool Genotype::add_connection(){
 // add random node mutation - return if the node is successfully added
 bool Genotype::add_node() {
         // check if there are existing connections 
-        if(connection_genes.empty())
+        if(genes.connection_count() == 0)
                 return false;
 
         // generate a random connection to add node
-        auto it = connection_genes.begin();
-        std::advance(it, rand_select({0, connection_genes.size() - 1}));
-        Connection& connection = *it;
+        const std::size_t index = rand_select({0, genes.connection_count() - 1});
+        const Connection connection = genes.connection(index);
         
         // disable the selected connection
         if (connection.enable)
-                connection.enable = false;
+                genes.set_enable(index, false);
         else
                 return false;
 
         // create a new hidden node
-        Node new_node{.node_number = node_genes.size() + 1, .node_type = NodeType::hidden};
-        node_genes.push_back(new_node);
+        Node new_node{.node_number = genes.node_count() + 1, .node_type = NodeType::hidden};
+        genes.add_node(new_node);
 
         // create two new connections
         // first connection: from input node of the disabled connection to the new node
-        connection_genes.push_back(Connection{
+        genes.add_connection(Connection{
                 .in = connection.in, .out = new_node.node_number, .weight = 1.0, .enable = true,
                 /**
                 * FIXME: each gene should pick up a new innovation number.
@@ -237,7 +298,7 @@ bool Genotype::add_node() {
         });
 
         // second connection: from the new node to the original output node
-        connection_genes.push_back(Connection{
+        genes.add_connection(Connection{
                 .in = new_node.node_number, .out = connection.out, .weight = connection.weight, .enable = true,
                 /**
                 * FIXME: each gene should pick up a new innovation number.
@@ -245,32 +306,60 @@ bool Genotype::add_node() {
                 */
                 .innov = 1
         });
-
-        // update the graph with the new connections
-        // remove the disabled connection
-        net.erase(connection.in, connection.out);
-        // add the connection from input node of the connection to the new node to the graph
-        net.add(connection.in, new_node.node_number, 1);
-        // add the second new connection to the graph
-        net.add(new_node.node_number, connection.out, connection.weight);
+        phenotype.reset();
 
         return true;
 }
 
-// randomly toggle (disable & enable) a connection - always success
+// randomly toggle (disable & enable) a connection - fails if enabling it would close a cycle
 bool Genotype::toggle_connection(){
         // randomly select one edge
-        auto it = connection_genes.begin();
-        std::advance(it, rand_select({0, connection_genes.size() - 1}));
-        Connection& connection = *it;
+        const std::size_t index = rand_select({0, genes.connection_count() - 1});
+        Connection connection = genes.connection(index);
+
+        // connections added while this one was disabled might have created a path from it's out node to it's in node
+        if(!connection.enable && GraphNet(genes).ancestors(connection.in).count(connection.out))
+                return false;
 
         // toggle the connection
         connection.enable = !connection.enable;
-        // update the edge in GraphNet
-        if(connection.enable)
-                assert(net.add(connection.in, connection.out, connection.weight));
-        else
-                assert(net.erase(connection.in, connection.out));
+        genes.set_enable(index, connection.enable);
+        phenotype.reset();
         
         return true;
 }
+
+// give a random hidden / output node another activation function - return if a node was changed
+bool Genotype::mutate_activation(){
+        std::vector<std::size_t> can;
+        for(std::size_t i = 0; i < genes.node_count(); ++i)
+                if(genes.node_type(i) != NodeType::sensor)
+                        can.push_back(i);
+        if(can.empty())
+                return false;
+
+        // pick one of the other activation functions
+        const std::size_t index = can.at(rand_select({0, can.size() - 1}));
+        const int64_t current = static_cast<int64_t>(genes.activation(index));
+        const int64_t count = static_cast<int64_t>(Activation::identity) + 1;
+        genes.set_activation(index, static_cast<Activation>((current + rand_select({1, count - 1})) % count));
+        phenotype.reset();
+
+        return true;
+}
+
+// perturb the bias of a random hidden / output node - return if a node was changed
+bool Genotype::mutate_bias(){
+        std::vector<std::size_t> can;
+        for(std::size_t i = 0; i < genes.node_count(); ++i)
+                if(genes.node_type(i) != NodeType::sensor)
+                        can.push_back(i);
+        if(can.empty())
+                return false;
+
+        const std::size_t index = can.at(rand_select({0, can.size() - 1}));
+        genes.set_bias(index, static_cast<float>(genes.bias(index) + rand_gaussian(0, 0.5)));
+        phenotype.reset();
+
+        return true;
+}
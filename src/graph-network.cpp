@@ -1,31 +1,27 @@
 #include "graph-network.hpp"
 #include "utility.hpp"
-#include <utility>
-#include <cassert>
+#include <algorithm>
 #include <stdexcept>
-#include <functional>
 #include <deque>
 
-// construct both graphs from list of connections
-void GraphNet::construct(const GraphNet::ConnectionList& connections){
-        for(auto connection : connections){
-                if(connection.enable){
-                        assert(add(connection.in, connection.out, connection.weight));
-                }
-        }
+// construct both graphs from the enabled connection genes
+GraphNet::GraphNet(const CompactGenes& genes){
+        for(std::size_t i = 0; i < genes.node_count(); ++i)
+                reserve(genes.node_number(i));
+        for(std::size_t i = 0; i < genes.connection_count(); ++i)
+                if(genes.enabled(i))
+                        add(genes.in(i), genes.out(i));
 }
 
 // add an edge to both graphs - if edge already exists, return false
-bool GraphNet::add(NodeID in_node, NodeID out_node, const long double weight){
+bool GraphNet::add(NodeID in_node, NodeID out_node){
         if(exist(in_node, out_node))
                 return false;
-        // add to both graphs
-        graph[in_node].insert(std::make_pair(out_node, weight));
-        Tgraph[out_node].insert(in_node);
-
         // keep updating the highest node number when adding edges
-        // new node must be added through adding edges
-        node_count = std::max(node_count, std::max(in_node, out_node));
+        reserve(std::max(in_node, out_node));
+        // add to both graphs
+        graph[in_node].push_back(static_cast<uint32_t>(out_node));
+        Tgraph[out_node].push_back(static_cast<uint32_t>(in_node));
 
         return true;
 }
@@ -35,8 +31,10 @@ bool GraphNet::erase(NodeID in_node, NodeID out_node){
         if(!exist(in_node, out_node))
                 return false;
         // erase from both graphs
-        graph[in_node].erase(out_node);
-        Tgraph[out_node].erase(in_node);
+        std::vector<uint32_t>& outs = graph[in_node];
+        outs.erase(std::find(outs.begin(), outs.end(), out_node));
+        std::vector<uint32_t>& ins = Tgraph[out_node];
+        ins.erase(std::find(ins.begin(), ins.end(), in_node));
 
         return true;
 }
@@ -51,85 +49,111 @@ std::set<uint64_t> GraphNet::children(NodeID node) const{
         return find_reachable(node, graph);
 }
 
-// return the topological ordering of the WEIGHTED graph
+// return the topological ordering of the graph
 std::vector<uint64_t> GraphNet::topsort() const{
         // this method use Kahn's algorithm for topological ordering
         std::vector<uint64_t> indeg(node_count + 1, 0); // node id start from 1
         // calculate the in degree of each vertex
-        for(auto& [in, outs] : graph)
-                for(auto& out : outs)
-                        indeg.at(out.first)++;
-        
+        for(auto& outs : graph)
+                for(auto out : outs)
+                        indeg[out]++;
+
         // obtain all the nodes with in degree 0
         std::deque<uint64_t> q;
         for(uint64_t node = 1; node <= node_count; ++node)
                 if(indeg[node] == 0)
                         q.push_back(node);
 
-        // performing BFS        
+        // performing BFS
         std::vector<uint64_t> res;
         while(!q.empty()){
                 uint64_t node = q.front();
                 q.pop_front();
                 res.push_back(node);
-                // decrease the degree of adjacent nodes; if no adjacent nodes (ie. output nodes) skip
-                if(!graph.count(node))
-                        continue;
-                for(auto& adj : graph.at(node)){
-                        indeg.at(adj.first)--;
-                        if(indeg.at(adj.first) == 0)
-                                q.push_back(adj.first);
-                }
+                // decrease the degree of adjacent nodes
+                for(auto adj : graph[node])
+                        if(--indeg[adj] == 0)
+                                q.push_back(adj);
         }
 
         // check for a cycle
         if(res.size() != node_count)
                 throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"graph contains cycle(s)!"));
-        
+
         return res;
 }
 
-// check if there exists a cycle in the WEIGHTED graph
+// check if there exists a cycle in the graph
 bool GraphNet::has_cycle() const{
         // this method use DFS to detect a cycle in a directed graph
         // a cycle exists iff exists at least one back edge, so, you know...
+        // the state of a node: 0 unvisited, 1 on the current dfs path, 2 done
+        std::vector<uint8_t> state(node_count + 1, 0);
+        // explicit dfs stack of (node, index of the next adjacent node to visit)
+        std::vector<std::pair<uint64_t, std::size_t>> stk;
 
-        std::set<uint64_t> vis;
-        // the recursive call stack tracks all the visited nodes in the current dfs run
-        // if have an edge pointing back to one of the visited nodes, it's a back edge
-        std::set<uint64_t> stk;
-
-        std::function<bool(const uint64_t node)> dfs;
-        dfs = [&, this](const uint64_t node) -> bool {
-                if(!vis.count(node)){
-                        vis.insert(node);
-                        // if the node has no outgoing edges, simply end this search
-                        if(!graph.count(node))
-                                return false;
-                        stk.insert(node);
-
-                        for(auto& adj : graph.at(node)){
-                                if(!vis.count(adj.first) && dfs(adj.first))
-                                        return true;
-                                else if(stk.count(adj.first))
-                                        return true;
+        for(uint64_t root = 1; root <= node_count; ++root){
+                if(state[root])
+                        continue;
+                state[root] = 1;
+                stk.emplace_back(root, 0);
+                while(!stk.empty()){
+                        auto& [node, next] = stk.back();
+                        if(next == graph[node].size()){
+                                // remove the node from the call stack
+                                state[node] = 2;
+                                stk.pop_back();
+                                continue;
+                        }
+                        const uint64_t adj = graph[node][next++];
+                        if(state[adj] == 1) // back edge
+                                return true;
+                        if(state[adj] == 0){
+                                state[adj] = 1;
+                                stk.emplace_back(adj, 0);
                         }
                 }
+        }
 
-                // remove the node from the call stack
-                stk.erase(node);
-                return false;
-        };
-
-        for(uint64_t node = 1; node <= node_count; ++node)
-                if(!vis.count(node) && dfs(node))
-                        return true;
-        
         return false;
 }
 
 // check if an edge exists
 bool GraphNet::exist(NodeID in_node, NodeID out_node) const{
-        return (graph.count(in_node) && // in node must first exists and out node exists as a child of in node
-                graph.at(in_node).count(out_node));
+        if(in_node > node_count) // in node must first exists and out node exists as a child of in node
+                return false;
+        const std::vector<uint32_t>& outs = graph[in_node];
+        return std::find(outs.begin(), outs.end(), out_node) != outs.end();
+}
+
+// helper method to find reachable nodes in either graphs
+std::set<uint64_t> GraphNet::find_reachable(NodeID node, const Graph& g) const{
+        std::set<uint64_t> reachable;
+        std::deque<uint64_t> q;
+        q.push_back(node);
+
+        while(!q.empty()){
+                std::uint64_t node = q.front();
+                q.pop_front();
+                if(reachable.count(node))
+                        continue;
+                reachable.insert(node);
+
+                // add adjcent nodes
+                if(node > node_count)
+                        continue;
+                for(auto adj : g[node])
+                        q.push_back(adj);
+        }
+
+        return reachable;
+}
+
+// make room for the node numbers up to and including node
+void GraphNet::reserve(NodeID node){
+        if(node <= node_count)
+                return;
+        node_count = node;
+        graph.resize(node_count + 1);
+        Tgraph.resize(node_count + 1);
 }
@@ -0,0 +1,396 @@
+#include "lineage.hpp"
+#include "utility.hpp"
+#include <bit>
+#include <deque>
+#include <limits>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+
+namespace{
+        // magic header of .lineage files
+        constexpr char lineage_magic[8] = {'N', 'E', 'A', 'T', 'L', 'I', 'N', '3'};
+
+        // dispatch on the alternative held by a variant
+        template<typename... Fs>
+        struct overloaded : Fs... { using Fs::operator()...; };
+
+        // writers: integers take 7 bits per byte (low bits first, the top bit flags a following byte),
+        // floats and doubles are stored little endian
+        void put_varint(std::string& buf, uint64_t value){
+                for(; value >= 0x80; value >>= 7)
+                        buf.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                buf.push_back(static_cast<char>(value));
+        }
+
+        template<typename T>
+        void put_fixed(std::string& buf, const T value){
+                using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+                Bits bits = std::bit_cast<Bits>(value);
+                for(std::size_t i = 0; i < sizeof(T); ++i, bits >>= 8)
+                        buf.push_back(static_cast<char>(bits & 0xff));
+        }
+
+        // reader of the .lineage files - throws on a truncated or corrupted file
+        class Reader{
+            public:
+                explicit Reader(std::ifstream& in) : in{in} {}
+
+                char byte(){
+                        char c;
+                        if(!in.get(c))
+                                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"truncated .lineage file"));
+                        return c;
+                }
+
+                uint64_t varint(){
+                        uint64_t value = 0;
+                        for(unsigned shift = 0; shift < 64; shift += 7){
+                                const auto c = static_cast<unsigned char>(byte());
+                                value |= static_cast<uint64_t>(c & 0x7f) << shift;
+                                if(!(c & 0x80))
+                                        return value;
+                        }
+                        throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"corrupted .lineage file"));
+                }
+
+                // an integer that must fit in 32 bits (gene numbers and indices)
+                uint32_t varint32(){
+                        const uint64_t value = varint();
+                        if(value > std::numeric_limits<uint32_t>::max())
+                                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"corrupted .lineage file"));
+                        return static_cast<uint32_t>(value);
+                }
+
+                template<typename T>
+                T fixed(){
+                        using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+                        Bits bits = 0;
+                        for(std::size_t i = 0; i < sizeof(T); ++i)
+                                bits |= static_cast<Bits>(static_cast<unsigned char>(byte())) << (8 * i);
+                        return std::bit_cast<T>(bits);
+                }
+
+            private:
+                std::ifstream& in;
+        };
+}
+
+// keep a full keyframe every `interval` generations of a lineage
+LineageStore::LineageStore(const uint32_t interval) : interval{interval}{
+        if(interval == 0)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"keyframe interval must be positive"));
+}
+
+// load a store written by LineageStore::save
+LineageStore::LineageStore(const std::filesystem::path& lineage_file){
+        using namespace std::filesystem;
+        // check if the given path is valid
+        if(!exists(lineage_file) || is_empty(lineage_file))
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"cannot open source .lineage file"));
+        std::ifstream infile(absolute(lineage_file), std::ios::binary);
+        if(!infile.is_open())
+                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"cannot open source .lineage file"));
+
+        char magic[sizeof(lineage_magic)];
+        infile.read(magic, sizeof(magic));
+        if(!infile || !std::equal(std::begin(magic), std::end(magic), std::begin(lineage_magic)))
+                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"not a .lineage file"));
+
+        Reader in(infile);
+        interval = in.varint32();
+        if(interval == 0)
+                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"corrupted .lineage file"));
+        const uint64_t count = in.varint();
+        for(uint64_t r = 0; r < count; ++r){
+                const uint64_t id = in.varint();
+                Record record;
+                record.fitness = in.fixed<double>();
+                record.depth = in.varint32();
+                record.parents.resize(in.varint());
+                for(auto& parent : record.parents)
+                        parent = in.varint();
+
+                if(record.depth == 0){
+                        const uint64_t nodes = in.varint();
+                        for(uint64_t i = 0; i < nodes; ++i){
+                                Node node;
+                                node.node_number = in.varint32();
+                                node.node_type = Node::get_nodetype(in.byte());
+                                node.activation = Node::get_activation(in.byte());
+                                node.bias = in.fixed<float>();
+                                record.keyframe.add_node(node);
+                        }
+                        const uint64_t connections = in.varint();
+                        for(uint64_t i = 0; i < connections; ++i){
+                                Connection connection;
+                                connection.in = in.varint32();
+                                connection.out = in.varint32();
+                                connection.innov = in.varint32();
+                                connection.weight = in.fixed<float>();
+                                connection.enable = in.byte() != 0;
+                                record.keyframe.add_connection(connection);
+                        }
+                }else{
+                        record.deltas.resize(in.varint());
+                        for(auto& delta : record.deltas){
+                                switch(in.byte()){
+                                        case 0:{
+                                                const uint32_t number = in.varint32();
+                                                const NodeType type = Node::get_nodetype(in.byte());
+                                                const Activation activation = Node::get_activation(in.byte());
+                                                delta = AddNode{number, type, activation, in.fixed<float>()};
+                                                break;
+                                        }
+                                        case 1:{
+                                                const uint32_t from = in.varint32(), to = in.varint32(), innov = in.varint32();
+                                                const float weight = in.fixed<float>();
+                                                delta = AddConnection{from, to, innov, weight, in.byte() != 0};
+                                                break;
+                                        }
+                                        case 2: delta = Toggle{in.varint32()}; break;
+                                        case 3:{
+                                                const uint32_t index = in.varint32();
+                                                delta = SetWeight{index, in.fixed<float>()};
+                                                break;
+                                        }
+                                        case 4:{
+                                                const uint32_t index = in.varint32();
+                                                const Activation activation = Node::get_activation(in.byte());
+                                                delta = SetNode{index, activation, in.fixed<float>()};
+                                                break;
+                                        }
+                                        default:
+                                                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"corrupted .lineage file"));
+                                }
+                        }
+                }
+                records.emplace(id, std::move(record));
+        }
+}
+
+// record a genotype (and it's score) under it's id number
+void LineageStore::record(const Genotype& geno, const std::vector<uint64_t>& parents){
+        if(records.count(geno.get_id()))
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"genotype already recorded"));
+
+        Record record{.parents = parents, .fitness = geno.fitness, .depth = 0, .keyframe = {}, .deltas = {}};
+        if(!parents.empty() && records.count(parents.front()) && at(parents.front()).depth + 1 < interval){
+                if(diff(rebuild(parents.front()), geno.get_genes(), record.deltas)){
+                        // keep the deltas only if they are smaller than the genes themselves
+                        std::string deltas, genes;
+                        encode(deltas, record.deltas);
+                        encode(genes, geno.get_genes());
+                        if(deltas.size() < genes.size())
+                                record.depth = at(parents.front()).depth + 1;
+                }
+                if(record.depth == 0)
+                        record.deltas.clear();
+        }
+
+        // keyframe
+        if(record.depth == 0)
+                record.keyframe = geno.get_genes();
+        records.emplace(geno.get_id(), std::move(record));
+}
+
+// rebuild a recorded genotype (the copy receives a new id number, the score is restored)
+Genotype LineageStore::reconstruct(const uint64_t id) const{
+        Genotype geno(rebuild(id));
+        geno.fitness = at(id).fitness;
+        return geno;
+}
+
+// parents of a recorded genotype
+const std::vector<uint64_t>& LineageStore::parents(const uint64_t id) const{
+        return at(id).parents;
+}
+
+// all the recorded ancestors of a genotype (closest first)
+std::vector<uint64_t> LineageStore::ancestors(const uint64_t id) const{
+        std::vector<uint64_t> res;
+        std::unordered_set<uint64_t> seen{id};
+        std::deque<uint64_t> q(at(id).parents.begin(), at(id).parents.end());
+        while(!q.empty()){
+                uint64_t node = q.front();
+                q.pop_front();
+                if(!seen.insert(node).second)
+                        continue;
+                res.push_back(node);
+                // parents that were never recorded end the search on that branch
+                if(records.count(node))
+                        q.insert(q.end(), records.at(node).parents.begin(), records.at(node).parents.end());
+        }
+        return res;
+}
+
+// number of keyframes among the recorded genotypes
+std::size_t LineageStore::keyframes() const noexcept{
+        return static_cast<std::size_t>(std::count_if(records.begin(), records.end(), [](const auto& record){
+                return record.second.depth == 0;
+        }));
+}
+
+// write the whole store to a binary .lineage file
+void LineageStore::save(const std::filesystem::path& lineage_file) const{
+        std::ofstream outfile(lineage_file, std::ios::binary);
+        if(!outfile.is_open())
+                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"cannot open target .lineage file"));
+
+        // records in id order, so that the same lineage always gives the same file
+        std::vector<uint64_t> ids;
+        for(auto& [id, record] : records)
+                ids.push_back(id);
+        std::sort(ids.begin(), ids.end());
+
+        std::string buf(lineage_magic, sizeof(lineage_magic));
+        put_varint(buf, interval);
+        put_varint(buf, ids.size());
+        for(auto id : ids){
+                const Record& record = records.at(id);
+                put_varint(buf, id);
+                put_fixed<double>(buf, static_cast<double>(record.fitness));
+                put_varint(buf, record.depth);
+                put_varint(buf, record.parents.size());
+                for(auto parent : record.parents)
+                        put_varint(buf, parent);
+
+                // keyframes hold the genes, the other records only the deltas
+                if(record.depth == 0)
+                        encode(buf, record.keyframe);
+                else
+                        encode(buf, record.deltas);
+        }
+        outfile.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        if(!outfile)
+                throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"cannot write target .lineage file"));
+}
+
+// encoded form of a record's genes (as written in the .lineage files)
+void LineageStore::encode(std::string& buf, const CompactGenes& genes){
+        put_varint(buf, genes.node_count());
+        for(std::size_t i = 0; i < genes.node_count(); ++i){
+                put_varint(buf, genes.node_number(i));
+                buf.push_back(Node::get_nodetype(genes.node_type(i)));
+                buf.push_back(Node::get_activation(genes.activation(i)));
+                put_fixed(buf, genes.bias(i));
+        }
+        put_varint(buf, genes.connection_count());
+        for(std::size_t i = 0; i < genes.connection_count(); ++i){
+                put_varint(buf, genes.in(i));
+                put_varint(buf, genes.out(i));
+                put_varint(buf, genes.innov(i));
+                put_fixed(buf, genes.weight(i));
+                buf.push_back(static_cast<char>(genes.enabled(i)));
+        }
+}
+
+// encoded form of a record's deltas (as written in the .lineage files): the alternative, then it's fields
+void LineageStore::encode(std::string& buf, const std::vector<Delta>& deltas){
+        put_varint(buf, deltas.size());
+        for(auto& delta : deltas){
+                buf.push_back(static_cast<char>(delta.index()));
+                std::visit(overloaded{
+                        [&](const AddNode& d){
+                                put_varint(buf, d.number);
+                                buf.push_back(Node::get_nodetype(d.type));
+                                buf.push_back(Node::get_activation(d.activation));
+                                put_fixed(buf, d.bias);
+                        },
+                        [&](const AddConnection& d){
+                                put_varint(buf, d.in);
+                                put_varint(buf, d.out);
+                                put_varint(buf, d.innov);
+                                put_fixed(buf, d.weight);
+                                buf.push_back(static_cast<char>(d.enable));
+                        },
+                        [&](const Toggle& d){ put_varint(buf, d.index); },
+                        [&](const SetWeight& d){ put_varint(buf, d.index), put_fixed(buf, d.weight); },
+                        [&](const SetNode& d){
+                                put_varint(buf, d.index);
+                                buf.push_back(Node::get_activation(d.activation));
+                                put_fixed(buf, d.bias);
+                        }
+                }, delta);
+        }
+}
+
+// genes of a recorded genotype
+CompactGenes LineageStore::rebuild(const uint64_t id) const{
+        // walk up to the closest keyframe, then replay the deltas back down
+        std::vector<const Record*> chain{&at(id)};
+        while(chain.back()->depth != 0)
+                chain.push_back(&at(chain.back()->parents.front()));
+
+        // copying the keyframe shares it's storage, only the genes the deltas touch are copied
+        CompactGenes genes = chain.back()->keyframe;
+        auto check = [](const uint32_t index, const std::size_t count){
+                if(index >= count)
+                        throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"delta refers to a missing gene"));
+        };
+        for(auto record = chain.rbegin() + 1; record != chain.rend(); ++record){
+                for(auto& delta : (*record)->deltas){
+                        std::visit(overloaded{
+                                [&](const AddNode& d){
+                                        genes.add_node(Node{.node_number = d.number, .node_type = d.type,
+                                                            .activation = d.activation, .bias = d.bias});
+                                },
+                                [&](const AddConnection& d){
+                                        genes.add_connection(Connection{.in = d.in, .out = d.out, .weight = d.weight,
+                                                                        .enable = d.enable, .innov = d.innov});
+                                },
+                                [&](const Toggle& d){
+                                        check(d.index, genes.connection_count());
+                                        genes.set_enable(d.index, !genes.enabled(d.index));
+                                },
+                                [&](const SetWeight& d){
+                                        check(d.index, genes.connection_count());
+                                        genes.set_weight(d.index, d.weight);
+                                },
+                                [&](const SetNode& d){
+                                        check(d.index, genes.node_count());
+                                        genes.set_activation(d.index, d.activation);
+                                        genes.set_bias(d.index, d.bias);
+                                }
+                        }, delta);
+                }
+        }
+        return genes;
+}
+
+// compute the deltas from parent genes to child genes - false if the child does not descend from them
+bool LineageStore::diff(const CompactGenes& parent, const CompactGenes& child, std::vector<Delta>& deltas){
+        // mutations only ever append genes, so the parent's genes must be a prefix of the child's genes
+        if(child.node_count() < parent.node_count() || child.connection_count() < parent.connection_count())
+                return false;
+
+        for(std::size_t i = 0; i < parent.node_count(); ++i){
+                if(child.node_number(i) != parent.node_number(i) || child.node_type(i) != parent.node_type(i))
+                        return false;
+                if(child.activation(i) != parent.activation(i) || child.bias(i) != parent.bias(i))
+                        deltas.push_back(SetNode{static_cast<uint32_t>(i), child.activation(i), child.bias(i)});
+        }
+        for(std::size_t i = parent.node_count(); i < child.node_count(); ++i)
+                deltas.push_back(AddNode{child.node_number(i), child.node_type(i), child.activation(i), child.bias(i)});
+
+        for(std::size_t i = 0; i < parent.connection_count(); ++i){
+                if(child.in(i) != parent.in(i) || child.out(i) != parent.out(i) || child.innov(i) != parent.innov(i))
+                        return false;
+                if(child.enabled(i) != parent.enabled(i))
+                        deltas.push_back(Toggle{static_cast<uint32_t>(i)});
+                if(child.weight(i) != parent.weight(i))
+                        deltas.push_back(SetWeight{static_cast<uint32_t>(i), child.weight(i)});
+        }
+        for(std::size_t i = parent.connection_count(); i < child.connection_count(); ++i)
+                deltas.push_back(AddConnection{child.in(i), child.out(i), child.innov(i), child.weight(i), child.enabled(i)});
+        return true;
+}
+
+const LineageStore::Record& LineageStore::at(const uint64_t id) const{
+        auto it = records.find(id);
+        if(it == records.end())
+                throw std::out_of_range(make_errmsg(__FILE__,__LINE__,"genotype not recorded"));
+        return it->second;
+}
@@ -0,0 +1,193 @@
+#include "novelty.hpp"
+#include "utility.hpp"
+#include <queue>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+// every point of the tree has `dim` coordinates
+VPTree::VPTree(const std::size_t dim) : dim{dim}{
+}
+
+// add a point (the tree is rebuilt when the unindexed tail gets too long)
+void VPTree::insert(const std::vector<long double>& point){
+        if(point.size() != dim)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"behaviour dimension mismatch"));
+        points.insert(points.end(), point.begin(), point.end());
+        ++count;
+
+        if(count - indexed > std::max<std::size_t>(32, indexed / 2))
+                rebuild();
+}
+
+// index every point inserted so far
+void VPTree::rebuild(){
+        std::vector<uint32_t> ids(count);
+        std::iota(ids.begin(), ids.end(), 0);
+        nodes.clear();
+        nodes.reserve(count);
+        root = build(ids, 0, ids.size());
+        indexed = count;
+}
+
+// build the subtree over ids[begin, end), return it's root
+int32_t VPTree::build(std::vector<uint32_t>& ids, const std::size_t begin, const std::size_t end){
+        if(begin == end)
+                return -1;
+
+        // the first point becomes the vantage point (the ids are in no particular order below the root)
+        const int32_t node = static_cast<int32_t>(nodes.size());
+        nodes.push_back(Node{.point = ids.at(begin), .radius = 0, .inside = -1, .outside = -1});
+        if(end - begin == 1)
+                return node;
+
+        // split the other points at the median distance from the vantage point
+        const double* vp = points.data() + static_cast<std::size_t>(ids.at(begin)) * dim;
+        std::vector<std::pair<double, uint32_t>> by_distance;
+        for(std::size_t i = begin + 1; i < end; ++i)
+                by_distance.emplace_back(distance(vp, ids.at(i)), ids.at(i));
+        const std::size_t half = by_distance.size() / 2;
+        std::nth_element(by_distance.begin(), by_distance.begin() + half, by_distance.end());
+        for(std::size_t i = 0; i < by_distance.size(); ++i)
+                ids.at(begin + 1 + i) = by_distance.at(i).second;
+        const std::size_t mid = begin + 1 + half;
+        nodes.at(node).radius = by_distance.at(half).first;
+
+        const int32_t inside = build(ids, begin + 1, mid);
+        const int32_t outside = build(ids, mid, end);
+        nodes.at(node).inside = inside;
+        nodes.at(node).outside = outside;
+        return node;
+}
+
+// distance between a query and a stored point
+double VPTree::distance(const double* query, const uint32_t point) const{
+        const double* p = points.data() + static_cast<std::size_t>(point) * dim;
+        double sum = 0;
+        for(std::size_t d = 0; d < dim; ++d)
+                sum += (query[d] - p[d]) * (query[d] - p[d]);
+        return std::sqrt(sum);
+}
+
+// distances to the k nearest points, ascending; the point numbered `skip` (insertion order) is ignored
+std::vector<double> VPTree::nearest(const std::vector<long double>& query, const std::size_t k, const std::size_t skip) const{
+        if(query.size() != dim)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"behaviour dimension mismatch"));
+        const std::vector<double> q(query.begin(), query.end());
+
+        // max heap of the k best distances so far
+        std::priority_queue<double> best;
+        auto offer = [&](const uint32_t point){
+                if(point == skip)
+                        return;
+                const double d = distance(q.data(), point);
+                if(best.size() < k)
+                        best.push(d);
+                else if(d < best.top())
+                        best.pop(), best.push(d);
+        };
+        auto tau = [&](){ return best.size() < k ? std::numeric_limits<double>::infinity() : best.top(); };
+
+        if(k > 0){
+                // indexed points: descend the tree, pruning the subtrees that cannot hold a closer point
+                // (each stacked subtree carries a lower bound of the distance from the query to it's points)
+                std::vector<std::pair<int32_t, double>> stack;
+                if(root != -1)
+                        stack.emplace_back(root, 0);
+                while(!stack.empty()){
+                        const auto [index, bound] = stack.back();
+                        stack.pop_back();
+                        if(bound > tau())
+                                continue;
+                        const Node& node = nodes.at(index);
+                        const double d = distance(q.data(), node.point);
+                        offer(node.point);
+                        // visit the side of the query last so that it's popped first
+                        const bool in_first = d < node.radius;
+                        const int32_t near = in_first ? node.inside : node.outside;
+                        const int32_t far = in_first ? node.outside : node.inside;
+                        if(far != -1)
+                                stack.emplace_back(far, std::abs(d - node.radius));
+                        if(near != -1)
+                                stack.emplace_back(near, 0);
+                }
+
+                // unindexed tail
+                for(std::size_t point = indexed; point < count; ++point)
+                        offer(static_cast<uint32_t>(point));
+        }
+
+        std::vector<double> res;
+        for(; !best.empty(); best.pop())
+                res.push_back(best.top());
+        std::reverse(res.begin(), res.end());
+        return res;
+}
+
+// k nearest neighbours, archive threshold, number of query threads
+NoveltySearch::NoveltySearch(const std::size_t k, const long double threshold, const std::size_t threads)
+        : k{k}, threads{threads}, threshold{threshold}{
+        if(k == 0 || threads == 0)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"k and threads must be positive"));
+}
+
+// replace the fitness of every genotype by it's novelty, then update the archive
+void NoveltySearch::assign(const std::vector<Genotype*>& population){
+        if(population.empty())
+                return;
+        const std::size_t dim = population.front()->behaviour.size();
+        if(archive.size() == 0 && archive.dimension() != dim)
+                archive = VPTree(dim);
+        // checked here, the queries below run on worker threads
+        if(archive.dimension() != dim)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"behaviour dimension mismatch"));
+
+        // index the current population once, every genotype queries it and the archive
+        VPTree current(dim);
+        for(auto geno : population)
+                current.insert(geno->behaviour);
+        current.rebuild();
+
+        // the first exception of a query (e.g. out of memory) is rethrown once every worker has stopped
+        std::vector<long double> novelty(population.size());
+        std::mutex mtx;
+        std::exception_ptr error;
+        auto query = [&](const std::size_t first, const std::size_t last) noexcept{
+                try{
+                        for(std::size_t i = first; i < last; ++i){
+                                // the genotype itself is part of the population, skip it
+                                std::vector<double> near = current.nearest(population.at(i)->behaviour, k, i);
+                                std::vector<double> old = archive.nearest(population.at(i)->behaviour, k);
+                                near.insert(near.end(), old.begin(), old.end());
+                                std::sort(near.begin(), near.end());
+                                near.resize(std::min(near.size(), k));
+                                novelty.at(i) = near.empty() ? 0 : std::accumulate(near.begin(), near.end(), 0.0L) / near.size();
+                        }
+                }catch(...){
+                        std::lock_guard<std::mutex> lock(mtx);
+                        if(!error)
+                                error = std::current_exception();
+                }
+        };
+
+        const std::size_t workers = std::min(threads, population.size());
+        const std::size_t chunk = (population.size() + workers - 1) / workers;
+        std::vector<std::thread> pool;
+        for(std::size_t w = 1; w < workers; ++w)
+                pool.emplace_back(query, std::min(w * chunk, population.size()), std::min((w + 1) * chunk, population.size()));
+        query(0, std::min(chunk, population.size()));
+        for(auto& t : pool)
+                t.join();
+        if(error)
+                std::rethrow_exception(error);
+
+        for(std::size_t i = 0; i < population.size(); ++i){
+                population.at(i)->fitness = novelty.at(i);
+                if(novelty.at(i) > threshold)
+                        archive.insert(population.at(i)->behaviour);
+        }
+}
@@ -0,0 +1,120 @@
+#include "population-kernel.hpp"
+#include "activation.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+// pack the compiled networks - all of them must have the same number of sensor nodes
+PopulationKernel::PopulationKernel(const std::vector<std::shared_ptr<const CompiledNet>>& nets, const bool shared_inputs){
+        if(nets.empty())
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"cannot pack an empty population"));
+        sensors = nets.front()->sensors();
+        std::size_t depth = 0;
+        for(auto& net : nets){
+                if(net->sensors() != sensors)
+                        throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"networks have different sensor counts"));
+                depth = std::max(depth, net->layers());
+        }
+
+        // slot -> row mapping of each network; the sensor slots map onto the shared input rows,
+        // or onto the network's own block of input rows
+        const uint32_t input_rows = static_cast<uint32_t>(shared_inputs ? sensors : sensors * nets.size());
+        std::vector<std::vector<uint32_t>> row(nets.size());
+        for(std::size_t n = 0; n < nets.size(); ++n){
+                row.at(n).resize(nets.at(n)->slots());
+                for(uint32_t s = 0; s < sensors; ++s)
+                        row.at(n).at(s) = static_cast<uint32_t>(shared_inputs ? s : n * sensors + s);
+        }
+
+        // lay the rows out layer by layer across all the networks; within a layer, the rows of every network
+        // sharing an activation function are gathered into a single group
+        uint32_t rows = input_rows;
+        layer_begin = {0, rows};
+        layer_group = {0, 0};
+        edge_begin = {0, 0};
+        bias.assign(input_rows, 0);
+        for(std::size_t l = 1; l < depth; ++l){
+                for(const Activation activation : {Activation::sigmoid, Activation::tanh, Activation::relu,
+                                                   Activation::gaussian, Activation::sin, Activation::identity}){
+                        const uint32_t first = rows;
+                        for(std::size_t n = 0; n < nets.size(); ++n){
+                                const CompiledNet& net = *nets.at(n);
+                                if(l >= net.layers())
+                                        continue;
+                                for(uint32_t g = net.layer_group.at(l); g < net.layer_group.at(l + 1); ++g){
+                                        if(net.group_activation.at(g) != activation)
+                                                continue;
+                                        for(uint32_t s = net.group_begin.at(g); s < net.group_begin.at(g + 1); ++s){
+                                                row.at(n).at(s) = rows++;
+                                                bias.push_back(net.bias.at(s));
+                                        }
+                                }
+                        }
+                        if(rows != first){
+                                group_begin.push_back(first);
+                                group_activation.push_back(activation);
+                        }
+                }
+                layer_begin.push_back(rows);
+                layer_group.push_back(static_cast<uint32_t>(group_activation.size()));
+
+                // the inputs of a layer all come from earlier layers, so their rows are already known
+                for(std::size_t n = 0; n < nets.size(); ++n){
+                        const CompiledNet& net = *nets.at(n);
+                        if(l >= net.layers())
+                                continue;
+                        for(uint32_t e = net.edge_begin.at(l); e < net.edge_begin.at(l + 1); ++e){
+                                edge_src.push_back(row.at(n).at(net.edge_src.at(e)));
+                                edge_dst.push_back(row.at(n).at(net.edge_dst.at(e)));
+                                edge_weight.push_back(net.edge_weight.at(e));
+                        }
+                }
+                edge_begin.push_back(static_cast<uint32_t>(edge_src.size()));
+        }
+
+        group_begin.push_back(rows);
+
+        output_begin.push_back(0);
+        for(std::size_t n = 0; n < nets.size(); ++n){
+                for(auto s : nets.at(n)->output_slots)
+                        output_rows.push_back(row.at(n).at(s));
+                output_begin.push_back(static_cast<uint32_t>(output_rows.size()));
+        }
+}
+
+// propogate every network over the batch
+void PopulationKernel::evaluate(const std::vector<Scalar>& inputs, const std::size_t batch){
+        if(inputs.size() != static_cast<std::size_t>(layer_begin.at(1)) * batch)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"input batch does not match the sensor count"));
+        this->batch = batch;
+
+        // sensor rows hold the inputs, every other row starts from it's node's bias
+        values.resize(static_cast<std::size_t>(layer_begin.back()) * batch);
+        std::copy(inputs.begin(), inputs.end(), values.begin());
+        for(std::size_t r = layer_begin[1]; r < bias.size(); ++r)
+                std::fill_n(values.begin() + r * batch, batch, bias[r]);
+
+        Scalar* const data = values.data();
+        for(std::size_t l = 1; l + 1 < layer_begin.size(); ++l){
+                // accumulate the incoming edges of the whole layer; rows never alias (src lives in an earlier layer)
+                for(uint32_t e = edge_begin[l]; e < edge_begin[l + 1]; ++e){
+                        const Scalar w = edge_weight[e];
+                        const Scalar* __restrict__ src = data + static_cast<std::size_t>(edge_src[e]) * batch;
+                        Scalar* __restrict__ dst = data + static_cast<std::size_t>(edge_dst[e]) * batch;
+                        for(std::size_t b = 0; b < batch; ++b)
+                                dst[b] += w * src[b];
+                }
+
+                // the rows of a group are contiguous, activate each group in a single sweep
+                for(uint32_t g = layer_group[l]; g < layer_group[l + 1]; ++g)
+                        FastActivation::apply(group_activation[g], data + static_cast<std::size_t>(group_begin[g]) * batch,
+                                              static_cast<std::size_t>(group_begin[g + 1] - group_begin[g]) * batch);
+        }
+}
+
+// after evaluate: the row of `batch` values of the k-th output node (by node number) of a network
+const PopulationKernel::Scalar* PopulationKernel::output(const std::size_t net, const std::size_t k) const{
+        if(k >= outputs(net))
+                throw std::out_of_range(make_errmsg(__FILE__,__LINE__,"output index out of range"));
+        return values.data() + static_cast<std::size_t>(output_rows.at(output_begin.at(net) + k)) * batch;
+}
@@ -1,7 +1,9 @@
 #include "prob.hpp"
 #include "utility.hpp"
+#include <limits>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <iostream>
 
 void GenotypeProbing::dumpfile(const Genotype &geno, const std::string& file_name){
@@ -13,21 +15,35 @@ void GenotypeProbing::dumpfile(const Genotype &geno, const std::string& file_nam
                 throw std::runtime_error(make_errmsg(__FILE__,__LINE__,"cannot open target .model file"));
         }
 
+        // unpack the genes for writing
+        const Genotype::NodeList nodes = geno.genes.nodes();
+        const Genotype::ConnectionList connections = geno.genes.connections();
+
         // write node genes
         // write node number
-        outfile << std::to_string(geno.node_genes.size()) << std::endl;
-        for(auto& node : geno.node_genes)
+        outfile << std::to_string(nodes.size()) << std::endl;
+        for(auto& node : nodes)
                 outfile << std::to_string(node.node_number) << ' ';
         outfile << std::endl;
         // write node type
-        for(auto& node : geno.node_genes)
+        for(auto& node : nodes)
                 outfile << Node::get_nodetype(node.node_type) << ' ';
         outfile << std::endl;
 
         // write connection genes
-        outfile << std::to_string(geno.connection_genes.size()) << std::endl;
-        for(auto& connect : geno.connection_genes)
+        outfile << std::to_string(connections.size()) << std::endl;
+        for(auto& connect : connections)
                 outfile << Connection::make_connect(connect) << std::endl;
+
+        // write node activations and biases (trailing section, optional when reading)
+        outfile << std::to_string(nodes.size()) << std::endl;
+        for(auto& node : nodes)
+                outfile << Node::get_activation(node.activation) << ' ';
+        outfile << std::endl;
+        outfile << std::setprecision(std::numeric_limits<long double>::max_digits10);
+        for(auto& node : nodes)
+                outfile << node.bias << ' ';
+        outfile << std::endl;
 }
 
 void GenotypeProbing::dump(const Genotype &geno, const std::string& file_name){
@@ -40,18 +56,26 @@ void GenotypeProbing::dump(const Genotype &geno){
 
 // print the node genes and connection genes for debugging
 void GenotypeProbing::print_node(const Genotype& geno){
-        std::cout << geno.node_genes.size() << std::endl;
-        for(auto& node : geno.node_genes)
+        const Genotype::NodeList nodes = geno.genes.nodes();
+        std::cout << nodes.size() << std::endl;
+        for(auto& node : nodes)
                 std::cout << node.node_number << ' ';
         std::cout << std::endl;
-        for(auto& node : geno.node_genes)
+        for(auto& node : nodes)
                 std::cout << Node::get_nodetype(node.node_type) << ' ';
         std::cout << std::endl;
+        for(auto& node : nodes)
+                std::cout << Node::get_activation(node.activation) << ' ';
+        std::cout << std::endl;
+        for(auto& node : nodes)
+                std::cout << node.bias << ' ';
+        std::cout << std::endl;
 }
 
 void GenotypeProbing::print_connection(const Genotype& geno){
-        std::cout << geno.connection_genes.size() << std::endl;
-        for(auto& connection : geno.connection_genes)
+        const Genotype::ConnectionList connections = geno.genes.connections();
+        std::cout << connections.size() << std::endl;
+        for(auto& connection : connections)
                 std::cout << Connection::make_connect(connection) << std::endl;
 }
 
@@ -68,8 +92,10 @@ void GenotypeProbing::generate_dot(const Genotype& geno, const std::filesystem::
         dotfile << "    edge [fontname=\"Helvetica\", fontsize=10];\n";
         
         // generate node genes
+        const Genotype::NodeList nodes = geno.genes.nodes();
+        const Genotype::ConnectionList connections = geno.genes.connections();
         // generate nodes number and type
-        for (auto& node : geno.node_genes) {
+        for (auto& node : nodes) {
                 std::string color;
                 switch (node.node_type) {
                         case NodeType::sensor: color = "green2"; break;
@@ -81,7 +107,7 @@ void GenotypeProbing::generate_dot(const Genotype& geno, const std::filesystem::
         }
         
         // generate connection genes
-        for (auto& connect : geno.connection_genes) {
+        for (auto& connect : connections) {
                 dotfile << "    " << connect.in << " -> " << connect.out 
                         << " [label=\"Weight: " << connect.weight 
                         << "\", color=" << (connect.enable ? "blue" : "red") << "];\n";
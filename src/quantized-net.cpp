@@ -0,0 +1,164 @@
+#include "quantized-net.hpp"
+#include "activation.hpp"
+#include "utility.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+// quantize a compiled network, calibrating the node ranges on the sample inputs
+QuantizedNet::QuantizedNet(const CompiledNet& net, const std::vector<Sample>& samples)
+        : sensors{net.sensors()}, layer_begin{net.layer_begin}, edge_begin{net.edge_begin},
+          edge_src{net.edge_src}, edge_dst{net.edge_dst}, output_slots{net.output_slots}{
+        if(samples.empty())
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"calibration needs at least one sample"));
+
+        // calibration: range of every node's input and magnitude of every node's value
+        const std::size_t slots = net.slots();
+        std::vector<Scalar> low(slots, std::numeric_limits<Scalar>::max());
+        std::vector<Scalar> high(slots, std::numeric_limits<Scalar>::lowest());
+        std::vector<Scalar> peak(slots, 0);
+        std::vector<Scalar> input, value;
+        for(auto& sample : samples){
+                trace(net, sample, input, value);
+                for(std::size_t s = 0; s < slots; ++s){
+                        low[s] = std::min(low[s], input[s]);
+                        high[s] = std::max(high[s], input[s]);
+                        peak[s] = std::max(peak[s], std::abs(value[s]));
+                }
+        }
+        value_scale.resize(slots);
+        for(std::size_t s = 0; s < slots; ++s)
+                value_scale[s] = peak[s] > 0 ? peak[s] / 127 : 1;
+
+        // weights: the value scale of the source is folded in, then each node gets a symmetric int8 scale
+        std::vector<Scalar> folded(net.edge_weight.size());
+        std::vector<Scalar> weight_peak(slots, 0);
+        for(std::size_t e = 0; e < folded.size(); ++e){
+                folded[e] = net.edge_weight[e] * value_scale[edge_src[e]];
+                weight_peak[edge_dst[e]] = std::max(weight_peak[edge_dst[e]], std::abs(folded[e]));
+        }
+        // (a bias much larger than the weights coarsens the scale, the bias must fit in the accumulator)
+        std::vector<Scalar> weight_scale(slots);
+        for(std::size_t s = 0; s < slots; ++s)
+                weight_scale[s] = std::max(weight_peak[s] > 0 ? weight_peak[s] / 127 : 1, std::abs(net.bias[s]) / max_acc_bias);
+        edge_weight.resize(folded.size());
+        for(std::size_t e = 0; e < folded.size(); ++e)
+                edge_weight[e] = quantize(folded[e], weight_scale[edge_dst[e]]);
+
+        // the bias of a node is the accumulator's starting value
+        acc_bias.assign(slots, 0);
+        for(std::size_t s = sensors; s < slots; ++s)
+                acc_bias[s] = static_cast<int32_t>(std::lround(net.bias[s] / weight_scale[s]));
+
+        // activation tables: the calibrated input range of a node is split into lut_size buckets,
+        // each bucket holds the quantized activation (of the node's own function) at it's center
+        std::vector<Activation> activation(slots, Activation::identity);
+        for(std::size_t g = 0; g < net.group_activation.size(); ++g)
+                std::fill(activation.begin() + net.group_begin[g], activation.begin() + net.group_begin[g + 1], net.group_activation[g]);
+        acc_low.assign(slots, 0);
+        acc_mult.assign(slots, 0);
+        acc_shift.assign(slots, 0);
+        lut.assign(slots, {});
+        for(std::size_t s = sensors; s < slots; ++s){
+                const int32_t lo = static_cast<int32_t>(std::floor(low[s] / weight_scale[s]));
+                const int32_t hi = std::max(lo + 1, static_cast<int32_t>(std::ceil(high[s] / weight_scale[s])));
+                acc_low[s] = lo;
+                // bucket i covers [lo + i * (hi - lo) / lut_size, lo + (i + 1) * (hi - lo) / lut_size), the index is
+                // (acc - lo) * lut_size / (hi - lo) (acc == hi is clamped into the last bucket)
+                // - lut_size / (hi - lo) = m * 2^exponent with m in [1/2, 1): m * 2^mult_bits is the multiplier
+                const double ratio = static_cast<double>(lut_size) / (static_cast<double>(hi) - lo);
+                int exponent;
+                std::frexp(ratio, &exponent);
+                acc_shift[s] = mult_bits - exponent;
+                acc_mult[s] = static_cast<int32_t>(std::lround(std::ldexp(ratio, acc_shift[s])));
+                for(std::size_t i = 0; i < lut_size; ++i){
+                        const Scalar acc = lo + (static_cast<Scalar>(i) + Scalar{0.5}) * (hi - lo) / lut_size;
+                        lut[s][i] = quantize(FastActivation::apply(activation[s], acc * weight_scale[s]), value_scale[s]);
+                }
+        }
+}
+
+// propogate one sample, return the value of each output node (by node number)
+std::vector<QuantizedNet::Scalar> QuantizedNet::evaluate(const Sample& inputs) const{
+        std::vector<Scalar> out;
+        evaluate(inputs, out);
+        return out;
+}
+
+// same, into `out` - the int8 values and int32 accumulators live in per thread scratch buffers
+void QuantizedNet::evaluate(const Sample& inputs, std::vector<Scalar>& out) const{
+        if(inputs.size() != sensors)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"sample does not match the sensor count"));
+
+        thread_local std::vector<int8_t> value;
+        thread_local std::vector<int32_t> acc;
+        value.assign(value_scale.size(), 0);
+        acc.assign(acc_bias.begin(), acc_bias.end());
+        for(std::size_t s = 0; s < sensors; ++s)
+                value[s] = quantize(inputs[s], value_scale[s]);
+
+        for(std::size_t l = 1; l + 1 < layer_begin.size(); ++l){
+                // int8 x int8 products, accumulated in int32
+                for(uint32_t e = edge_begin[l]; e < edge_begin[l + 1]; ++e)
+                        acc[edge_dst[e]] += static_cast<int32_t>(edge_weight[e]) * static_cast<int32_t>(value[edge_src[e]]);
+                // table lookup activation
+                for(uint32_t s = layer_begin[l]; s < layer_begin[l + 1]; ++s){
+                        const int64_t index = (static_cast<int64_t>(acc[s]) - acc_low[s]) * acc_mult[s] >> acc_shift[s];
+                        value[s] = lut[s][std::clamp<int64_t>(index, 0, lut_size - 1)];
+                }
+        }
+
+        out.resize(output_slots.size());
+        for(std::size_t o = 0; o < output_slots.size(); ++o)
+                out[o] = value[output_slots[o]] * value_scale[output_slots[o]];
+}
+
+// compare the outputs with the original network over a set of samples
+QuantizedNet::Report QuantizedNet::compare(const CompiledNet& net, const std::vector<Sample>& samples) const{
+        Report report;
+        std::size_t count = 0;
+        std::vector<Scalar> input, value, quantized;
+        for(auto& sample : samples){
+                trace(net, sample, input, value);
+                evaluate(sample, quantized);
+                for(std::size_t o = 0; o < output_slots.size(); ++o){
+                        const Scalar error = std::abs(quantized[o] - value[net.output_slots[o]]);
+                        report.max_abs_error = std::max(report.max_abs_error, error);
+                        report.mean_abs_error += error;
+                        ++count;
+                }
+        }
+        report.samples = samples.size();
+        report.mean_abs_error = count ? report.mean_abs_error / count : 0;
+
+        // weights and biases of the float network against int8 weights, per node scales, biases, offsets,
+        // multipliers, shifts and tables
+        const std::size_t slots = value_scale.size();
+        report.float_bytes = (net.edge_weight.size() + net.bias.size()) * sizeof(Scalar);
+        report.quantized_bytes = edge_weight.size() * sizeof(int8_t)
+                               + slots * (sizeof(Scalar) + 4 * sizeof(int32_t))
+                               + (slots - sensors) * lut_size * sizeof(int8_t);
+        return report;
+}
+
+// float propogation recording the input (before activation) and value of every node
+void QuantizedNet::trace(const CompiledNet& net, const Sample& inputs, std::vector<Scalar>& input, std::vector<Scalar>& value){
+        if(inputs.size() != net.sensors())
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"sample does not match the sensor count"));
+        input = net.bias;
+        std::copy(inputs.begin(), inputs.end(), input.begin());
+        value = input;
+        for(std::size_t l = 1; l < net.layers(); ++l){
+                for(uint32_t e = net.edge_begin[l]; e < net.edge_begin[l + 1]; ++e)
+                        input[net.edge_dst[e]] += net.edge_weight[e] * value[net.edge_src[e]];
+                for(uint32_t g = net.layer_group[l]; g < net.layer_group[l + 1]; ++g)
+                        for(uint32_t s = net.group_begin[g]; s < net.group_begin[g + 1]; ++s)
+                                value[s] = FastActivation::apply(net.group_activation[g], input[s]);
+        }
+}
+
+// quantize a value with the given scale, saturating to [-127, 127]
+int8_t QuantizedNet::quantize(const Scalar x, const Scalar scale){
+        return static_cast<int8_t>(std::clamp<long>(std::lround(x / scale), -127, 127));
+}
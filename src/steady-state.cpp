@@ -0,0 +1,196 @@
+#include "steady-state.hpp"
+#include "utility.hpp"
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+// every worker gets it's own environment from the factory (the breeder is seeded from rand_select)
+SteadyState::SteadyState(const int inputs, const int outputs, const Config& config, EnvFactory factory)
+        : inputs{inputs}, outputs{outputs}, config{config}, factory{std::move(factory)},
+          rng(static_cast<uint64_t>(rand_select({0, std::numeric_limits<int64_t>::max()}))),
+          weight_mutation(config.weights){
+        if(config.capacity == 0 || config.threads == 0 || config.tournament == 0)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"capacity, threads and tournament must be positive"));
+        if(!this->factory)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"missing environment factory"));
+}
+
+// keep evolving until `evaluations` more genotypes have been evaluated (and inserted)
+void SteadyState::run(const std::size_t evaluations){
+        // build the environments up front, a throwing factory must not take a worker thread down
+        std::vector<std::unique_ptr<EvalInterface>> envs;
+        for(std::size_t i = 0; i < config.threads; ++i)
+                envs.push_back(factory());
+
+        Channel<Job> dispatch;
+        Channel<Result> done;
+        std::vector<std::thread> workers;
+        for(auto& env : envs)
+                workers.emplace_back(&SteadyState::work, this, std::ref(*env), std::ref(dispatch), std::ref(done));
+
+        // fill the pipeline: the initial population if there is none yet, otherwise enough offspring
+        // to keep every worker busy while the breeder catches up
+        std::size_t dispatched = 0, finished = 0;
+        const std::size_t seeds = std::min(evaluations, population ? 2 * config.threads : config.capacity);
+        for(; dispatched < seeds; ++dispatched)
+                dispatch.push(Job{
+                        .geno = population ? breed() : std::make_shared<Genotype>(inputs, outputs),
+                        .threshold = survival_threshold()
+                });
+
+        // every finished evaluation immediately turns into a new offspring
+        std::exception_ptr error;
+        while(finished < dispatched){
+                Result result = *done.pop();
+                ++finished;
+                if(result.error){
+                        if(!error)
+                                error = result.error;
+                        continue;
+                }
+                insert(std::move(result.geno));
+                if(dispatched < evaluations && !error){
+                        dispatch.push(Job{.geno = breed(), .threshold = survival_threshold()});
+                        ++dispatched;
+                }
+        }
+
+        dispatch.close();
+        for(auto& worker : workers)
+                worker.join();
+        if(error)
+                std::rethrow_exception(error);
+}
+
+// the fittest genotype in the population, nullptr if the population is empty
+std::shared_ptr<const Genotype> SteadyState::best() const{
+        std::shared_ptr<const Genotype> champion;
+        for(auto& s : species)
+                for(auto& member : s.members)
+                        if(!champion || member->fitness > champion->fitness)
+                                champion = member;
+        return champion;
+}
+
+// put an evaluated genotype into it's species, retire the worst individual if over capacity
+void SteadyState::insert(std::shared_ptr<Genotype> geno){
+        auto home = std::find_if(species.begin(), species.end(), [&](const Species& s){
+                return Genotype::distance(*s.representative, *geno, config.c1, config.c3) < config.compat_threshold;
+        });
+        if(home == species.end())
+                home = species.insert(species.end(), Species{.representative = geno, .members = {}});
+        home->members.push_back(std::move(geno));
+        represent(*home);
+
+        if(++population > config.capacity)
+                retire();
+}
+
+// make the fittest current member the representative of a species (the first one on ties)
+void SteadyState::represent(Species& s){
+        s.representative = *std::max_element(s.members.begin(), s.members.end(), [](auto& a, auto& b){
+                return a->fitness < b->fitness;
+        });
+}
+
+// retire the individual with the lowest adjusted fitness (fitness shared within it's species)
+void SteadyState::retire(){
+        auto worst_species = species.end();
+        std::size_t worst_member = 0;
+        long double worst = std::numeric_limits<long double>::infinity();
+        for(auto s = species.begin(); s != species.end(); ++s){
+                for(std::size_t i = 0; i < s->members.size(); ++i){
+                        long double adjusted = s->members.at(i)->fitness / s->members.size();
+                        if(adjusted < worst)
+                                worst = adjusted, worst_species = s, worst_member = i;
+                }
+        }
+        if(worst_species == species.end())
+                return;
+
+        auto& members = worst_species->members;
+        members.erase(members.begin() + static_cast<std::ptrdiff_t>(worst_member));
+        if(members.empty())
+                species.erase(worst_species);
+        else
+                represent(*worst_species);
+        --population;
+}
+
+// score a new genotype must reach so that it's not the one retired when it arrives
+long double SteadyState::survival_threshold() const{
+        // nobody is retired while the population is not full
+        if(population < config.capacity)
+                return -std::numeric_limits<long double>::infinity();
+
+        // joining a species of n members shares the newcomer's fitness f by n + 1 and lowers every member
+        // of that species to f_i / (n + 1); if f < f_i / (n_i + 1) for every member i, the newcomer has the
+        // lowest adjusted fitness whichever species it joins, so it's retired right away
+        // (the argument only holds for non-negative scores, racing is off otherwise)
+        long double threshold = std::numeric_limits<long double>::infinity();
+        for(auto& s : species){
+                for(auto& member : s.members){
+                        if(member->fitness < 0)
+                                return -std::numeric_limits<long double>::infinity();
+                        threshold = std::min(threshold, member->fitness / (s.members.size() + 1));
+                }
+        }
+        return threshold;
+}
+
+// pick a species (proportional to mean fitness) and a parent inside it (tournament), then clone and mutate
+// (structure, then weights)
+std::shared_ptr<Genotype> SteadyState::breed(){
+        // fitness proportionate selection of the species; uniform if nobody scored yet
+        std::vector<long double> weights;
+        for(auto& s : species){
+                long double total = 0;
+                for(auto& member : s.members)
+                        total += std::max<long double>(member->fitness, 0);
+                weights.push_back(total / s.members.size());
+        }
+        if(std::all_of(weights.begin(), weights.end(), [](const long double w){ return w <= 0; }))
+                std::fill(weights.begin(), weights.end(), 1);
+        std::discrete_distribution<std::size_t> pick_species(weights.begin(), weights.end());
+        auto s = species.begin();
+        std::advance(s, pick_species(rng));
+
+        // tournament inside the species
+        std::uniform_int_distribution<std::size_t> pick_member(0, s->members.size() - 1);
+        std::shared_ptr<Genotype> parent = s->members.at(pick_member(rng));
+        for(std::size_t i = 1; i < config.tournament; ++i){
+                auto& challenger = s->members.at(pick_member(rng));
+                if(challenger->fitness > parent->fitness)
+                        parent = challenger;
+        }
+
+        // compile here so that a broken offspring never reaches a worker; fall back to a plain copy of the parent
+        for(int attempt = 0; attempt < 3; ++attempt){
+                try{
+                        auto child = std::make_shared<Genotype>(parent->clone());
+                        child->mutate();
+                        weight_mutation.apply(*child);
+                        child->compile();
+                        return child;
+                }catch(const std::runtime_error&){
+                        ++failures;
+                }
+        }
+        return std::make_shared<Genotype>(parent->clone());
+}
+
+// worker thread main loop
+void SteadyState::work(EvalInterface& env, Channel<Job>& dispatch, Channel<Result>& done) const{
+        while(auto job = dispatch.pop()){
+                EvalBudget budget = config.budget;
+                budget.threshold = job->threshold;
+                try{
+                        // a raced out genotype is still inserted, it's simply retired on arrival
+                        env.loop(*job->geno, budget);
+                        done.push(Result{.geno = std::move(job->geno), .error = nullptr});
+                }catch(...){
+                        done.push(Result{.geno = std::move(job->geno), .error = std::current_exception()});
+                }
+        }
+}
@@ -0,0 +1,116 @@
+#include "substrate.hpp"
+#include "activation.hpp"
+#include "population-kernel.hpp"
+#include "utility.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace{
+        // map a CPPN output to a weight in [-1, 1] according to the activation function of the output node
+        Substrate::Scalar to_weight(const Activation activation, const Substrate::Scalar out){
+                switch(activation){
+                        case Activation::sigmoid:
+                        case Activation::gaussian: return 2 * out - 1;
+                        case Activation::tanh:
+                        case Activation::sin: return out;
+                        default: return std::clamp<Substrate::Scalar>(out, -1, 1);
+                }
+        }
+}
+
+// layers of node coordinates: the first layer holds the inputs, the last one the outputs
+Substrate::Substrate(std::vector<std::vector<Point>> layers) : layers{std::move(layers)}{
+        if(this->layers.size() < 2)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"substrate needs at least 2 layers"));
+        if(std::any_of(this->layers.begin(), this->layers.end(), [](const std::vector<Point>& layer){ return layer.empty(); }))
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"substrate layers cannot be empty"));
+}
+
+// paint the weights with the CPPN
+void Substrate::build(Genotype& cppn, const Scalar threshold, const Scalar max_weight){
+        if(threshold < 0 || threshold >= 1)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"threshold must be within [0, 1)"));
+        auto net = cppn.compile();
+        if(net->sensors() != 4 || net->output_slots.empty())
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"CPPN needs 4 sensors and at least 1 output"));
+        PopulationKernel kernel({net});
+
+        // activation function of the output node giving the weights
+        const CompactGenes& genes = cppn.get_genes();
+        const uint64_t output = net->node_ids.at(net->output_slots.front());
+        Activation activation = Activation::sigmoid;
+        for(std::size_t i = 0; i < genes.node_count(); ++i)
+                if(genes.node_number(i) == output)
+                        activation = genes.activation(i);
+
+        matrices.assign(layers.size() - 1, SparseMatrix{});
+        std::vector<Scalar> inputs;
+        for(std::size_t l = 0; l + 1 < layers.size(); ++l){
+                const std::vector<Point>& src = layers.at(l);
+                const std::vector<Point>& dst = layers.at(l + 1);
+                SparseMatrix& matrix = matrices.at(l);
+                matrix.row_begin.assign(1, 0);
+
+                // pairs are enumerated row by row (pair p connects src[p % size] to dst[p / size]),
+                // so the CSR matrix is filled in order, one batch of CPPN queries at a time
+                const std::size_t pairs = src.size() * dst.size();
+                for(std::size_t first = 0; first < pairs; first += batch_size){
+                        const std::size_t batch = std::min(batch_size, pairs - first);
+                        inputs.resize(4 * batch);
+                        for(std::size_t b = 0; b < batch; ++b){
+                                const Point& from = src.at((first + b) % src.size());
+                                const Point& to = dst.at((first + b) / src.size());
+                                inputs[0 * batch + b] = from.x;
+                                inputs[1 * batch + b] = from.y;
+                                inputs[2 * batch + b] = to.x;
+                                inputs[3 * batch + b] = to.y;
+                        }
+                        kernel.evaluate(inputs, batch);
+
+                        const Scalar* out = kernel.output(0, 0);
+                        for(std::size_t b = 0; b < batch; ++b){
+                                const std::size_t p = first + b;
+                                const Scalar w = to_weight(activation, out[b]);
+                                if(std::abs(w) > threshold){
+                                        matrix.column.push_back(static_cast<uint32_t>(p % src.size()));
+                                        matrix.weight.push_back(std::copysign((std::abs(w) - threshold) / (1 - threshold) * max_weight, w));
+                                }
+                                // close the row after it's last column
+                                if(p % src.size() == src.size() - 1)
+                                        matrix.row_begin.push_back(static_cast<uint32_t>(matrix.column.size()));
+                        }
+                }
+        }
+}
+
+// propogate the substrate: one value per input node in, one value per output node out
+std::vector<Substrate::Scalar> Substrate::evaluate(const std::vector<Scalar>& inputs) const{
+        if(matrices.empty())
+                throw std::logic_error(make_errmsg(__FILE__,__LINE__,"substrate has not been built"));
+        if(inputs.size() != layers.front().size())
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"input size does not match the input layer"));
+
+        // sparse matrix-vector product per layer, then activation
+        std::vector<Scalar> value = inputs, next;
+        for(const SparseMatrix& matrix : matrices){
+                const std::size_t rows = matrix.row_begin.size() - 1;
+                next.assign(rows, 0);
+                for(std::size_t r = 0; r < rows; ++r){
+                        Scalar sum = 0;
+                        for(uint32_t e = matrix.row_begin[r]; e < matrix.row_begin[r + 1]; ++e)
+                                sum += matrix.weight[e] * value[matrix.column[e]];
+                        next[r] = FastActivation::apply(Activation::sigmoid, sum);
+                }
+                value.swap(next);
+        }
+        return value;
+}
+
+// number of connections kept by the last build
+std::size_t Substrate::connections() const noexcept{
+        std::size_t total = 0;
+        for(auto& matrix : matrices)
+                total += matrix.column.size();
+        return total;
+}
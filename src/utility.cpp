@@ -1,6 +1,18 @@
 #include "utility.hpp"
+#include <atomic>
 #include <random>
 
+namespace{
+        // every thread draws from it's own engine; unless seeded, the base comes from the system entropy
+        std::atomic<uint64_t> seed_base{std::random_device{}()};
+        std::atomic<uint64_t> seed_stream{0};
+
+        std::mt19937_64& engine(){
+                thread_local std::mt19937_64 eng(seed_base + 0x9e3779b97f4a7c15ULL * seed_stream++);
+                return eng;
+        }
+}
+
 // utility function to format a proper exception message
 std::string make_errmsg(const std::string& file, const int line, const std::string& msg){
         std::string errmsg;
@@ -8,9 +20,22 @@ std::string make_errmsg(const std::string& file, const int line, const std::stri
         return errmsg;
 }
 
+// utility function to seed the random numbers drawn by the calling thread
+void rand_seed(const uint64_t seed){
+        seed_base = seed;
+        engine().seed(seed);
+        // reset the streams last: creating the calling thread's engine above takes a stream number too
+        seed_stream = 1;
+}
+
 // utility function to randomly select a number in an inclusive range
 int64_t rand_select(const std::pair<int64_t, int64_t> range){
-        std::random_device rd;
         std::uniform_int_distribution<int64_t> uid(range.first, range.second);
-        return uid(rd);
+        return uid(engine());
+}
+
+// utility function to draw a number from a normal distribution
+long double rand_gaussian(const long double mean, const long double stddev){
+        std::normal_distribution<long double> nd(mean, stddev);
+        return nd(engine());
 }
@@ -0,0 +1,91 @@
+#include "vec-env.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+VecEnv::VecEnv(const std::size_t lanes, const std::size_t inputs, const std::size_t outputs)
+        : lane_count{lanes}, input_count{inputs}, output_count{outputs},
+          obs(lanes * inputs, 0), reward(lanes, 0), done(lanes, 0){
+        if(lanes == 0)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"a vectorized environment needs at least one lane"));
+}
+
+// start a new episode on every lane
+void VecEnv::reset(){
+        std::fill(reward.begin(), reward.end(), 0);
+        std::fill(done.begin(), done.end(), 1);
+        reset_lanes(done.data(), obs.data());
+        std::fill(done.begin(), done.end(), 0);
+}
+
+// apply one row of actions per lane and advance every lane by one tick (finished lanes are reset)
+void VecEnv::step(const std::vector<Scalar>& actions){
+        if(actions.size() != lane_count * output_count)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"action matrix does not match lanes x outputs"));
+        step_lanes(actions.data(), obs.data(), reward.data(), done.data());
+        if(std::find(done.begin(), done.end(), 1) != done.end())
+                reset_lanes(done.data(), obs.data());
+}
+
+// pack the population - the genotypes are compiled once and must outlive the evaluator
+VecEvaluator::VecEvaluator(const std::vector<Genotype*>& population)
+        : population{population}, sensors{population.empty() ? 0 : population.front()->compile()->sensors()},
+          kernel(compile(population), false){
+}
+
+// run the environment for `ticks` steps from a fresh reset
+uint64_t VecEvaluator::run(VecEnv& env, const uint64_t ticks){
+        const std::size_t nets = population.size();
+        if(env.lanes() % nets != 0)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"lanes must be a multiple of the population size"));
+        if(env.inputs() != sensors)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"environment inputs do not match the sensor count"));
+        for(std::size_t n = 0; n < nets; ++n)
+                if(kernel.outputs(n) != env.outputs())
+                        throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"environment outputs do not match the output count"));
+
+        const std::size_t per = env.lanes() / nets, in = env.inputs(), out = env.outputs();
+        inputs.resize(nets * sensors * per);
+        actions.resize(env.lanes() * out);
+        std::vector<long double> score(nets, 0);
+        uint64_t episodes = 0;
+
+        env.reset();
+        for(uint64_t t = 0; t < ticks; ++t){
+                // observation matrix (one row per lane) -> kernel rows (one row per sensor of each network)
+                const std::vector<Scalar>& obs = env.observations();
+                for(std::size_t n = 0; n < nets; ++n)
+                        for(std::size_t s = 0; s < sensors; ++s)
+                                for(std::size_t b = 0; b < per; ++b)
+                                        inputs[(n * sensors + s) * per + b] = obs[(n * per + b) * in + s];
+
+                kernel.evaluate(inputs, per);
+
+                // kernel output rows -> action matrix
+                for(std::size_t n = 0; n < nets; ++n){
+                        for(std::size_t o = 0; o < out; ++o){
+                                const Scalar* row = kernel.output(n, o);
+                                for(std::size_t b = 0; b < per; ++b)
+                                        actions[(n * per + b) * out + o] = row[b];
+                        }
+                }
+
+                env.step(actions);
+                for(std::size_t lane = 0; lane < env.lanes(); ++lane){
+                        score[lane / per] += env.rewards()[lane];
+                        episodes += env.dones()[lane];
+                }
+        }
+
+        for(std::size_t n = 0; n < nets; ++n)
+                population.at(n)->fitness = score.at(n) / per;
+        return episodes;
+}
+
+// compile every genotype of the population
+std::vector<std::shared_ptr<const CompiledNet>> VecEvaluator::compile(const std::vector<Genotype*>& population){
+        std::vector<std::shared_ptr<const CompiledNet>> nets;
+        for(auto geno : population)
+                nets.push_back(geno->compile());
+        return nets;
+}
@@ -0,0 +1,134 @@
+#include "weight-mutation.hpp"
+#include "utility.hpp"
+#include <bit>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+namespace{
+        uint64_t splitmix64(uint64_t& state) noexcept{
+                uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                return z ^ (z >> 31);
+        }
+
+        // probability p as a threshold on the top 24 bits of a draw: (r >> 8) < threshold(p) happens with probability p
+        // (compared as integers, so that the select does not count as a possibly trapping float comparison)
+        uint32_t threshold(const float p) noexcept{
+                return static_cast<uint32_t>(std::clamp(p, 0.0f, 1.0f) * 0x1p24f);
+        }
+
+        // approximately N(0, 1): four 16 bit uniforms summed, centered and scaled to unit variance
+        float gaussian(const uint32_t a, const uint32_t b) noexcept{
+                const int32_t sum = static_cast<int32_t>((a & 0xffff) + (a >> 16) + (b & 0xffff) + (b >> 16));
+                return static_cast<float>(sum - 2 * 65535) * (1.7320508f / 65536);
+        }
+}
+
+// the states are derived from the seed with splitmix64
+BulkRng::BulkRng(const uint64_t seed){
+        uint64_t state = seed;
+        for(std::size_t l = 0; l < lanes; ++l){
+                const uint64_t a = splitmix64(state), b = splitmix64(state);
+                s0[l] = static_cast<uint32_t>(a);
+                s1[l] = static_cast<uint32_t>(a >> 32);
+                s2[l] = static_cast<uint32_t>(b);
+                s3[l] = static_cast<uint32_t>(b >> 32) | 1; // never the all zero state
+        }
+}
+
+// fill out[0, n) with 32 bit random numbers - n must be a multiple of lanes
+void BulkRng::fill(uint32_t* __restrict__ out, const std::size_t n) noexcept{
+        for(std::size_t i = 0; i < n; i += lanes){
+                for(std::size_t l = 0; l < lanes; ++l){
+                        out[i + l] = s0[l] + s3[l];
+                        const uint32_t t = s1[l] << 9;
+                        s2[l] ^= s0[l];
+                        s3[l] ^= s1[l];
+                        s1[l] ^= s2[l];
+                        s0[l] ^= s3[l];
+                        s2[l] ^= t;
+                        s3[l] = (s3[l] << 11) | (s3[l] >> 21);
+                }
+        }
+}
+
+// the random numbers are seeded from rand_select, see rand_seed
+WeightMutation::WeightMutation(const Config& config)
+        : config{config}, rng(rand_select({0, std::numeric_limits<int64_t>::max()})),
+          draws(3 * CompactGenes::chunk_size){
+        if(config.perturb < 0 || config.replace < 0 || config.perturb + config.replace > 1)
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"perturb and replace must be probabilities summing to at most 1"));
+        static_assert(CompactGenes::chunk_size % BulkRng::lanes == 0);
+}
+
+// mutate the weights of the population, return the number of weights changed
+std::size_t WeightMutation::apply(const std::vector<Genotype*>& population){
+        std::size_t changed = 0;
+        for(Genotype* geno : population)
+                changed += apply(*geno);
+        return changed;
+}
+
+// mutate the weights of one genotype (e.g. an offspring), return the number of weights changed
+std::size_t WeightMutation::apply(Genotype& geno){
+        // one draw decides whether the genotype takes part
+        if((pick() >> 8) >= threshold(config.genome_rate))
+                return 0;
+        const std::size_t count = geno.genes.connection_count();
+        std::size_t changed = 0;
+        for(std::size_t c = 0; c < geno.genes.weight_chunks(); ++c){
+                const std::size_t n = std::min(CompactGenes::chunk_size, count - c * CompactGenes::chunk_size);
+                changed += mutate_chunk(geno.genes, c, n);
+        }
+        // only the genotypes that changed need to be compiled again
+        if(changed)
+                geno.phenotype.reset();
+        return changed;
+}
+
+// next random number of the genome_rate decisions (drawn in bulk, `lanes` at a time)
+uint32_t WeightMutation::pick() noexcept{
+        if(next_pick == picks.size()){
+                rng.fill(picks.data(), picks.size());
+                next_pick = 0;
+        }
+        return picks[next_pick++];
+}
+
+// mutate the first n weights of a chunk in place, return the number of weights changed
+std::size_t WeightMutation::mutate_chunk(CompactGenes& genes, const std::size_t chunk, const std::size_t n){
+        // only the random numbers the n weights need are drawn (n rounded up to the lane width), the decisions first
+        const std::size_t stride = (n + BulkRng::lanes - 1) / BulkRng::lanes * BulkRng::lanes;
+        rng.fill(draws.data(), stride);
+        const uint32_t* const decide = draws.data();
+        const uint32_t* const noise_a = draws.data() + stride;
+        const uint32_t* const noise_b = draws.data() + 2 * stride;
+
+        const uint32_t replace = threshold(config.replace), mutate = threshold(config.replace + config.perturb);
+        uint32_t changed = 0;
+        for(std::size_t i = 0; i < n; ++i)
+                changed += static_cast<uint32_t>((decide[i] >> 8) < mutate);
+        // a chunk left alone stays shared with the other copies of the genes (and needs no noise)
+        if(!changed)
+                return 0;
+        rng.fill(draws.data() + stride, 2 * stride);
+
+        float* const weights = genes.writable_weights(chunk);
+        const float power = config.power, stddev = config.replace_stddev;
+        for(std::size_t i = 0; i < n; ++i){
+                const uint32_t u = decide[i] >> 8;
+                const float z = gaussian(noise_a[i], noise_b[i]);
+                // both candidates are computed for every weight and the outcome is picked with bit masks, so that no
+                // float operation is conditional (the compiler does not if-convert those under -ftrapping-math)
+                const float w = weights[i], perturbed = w + z * power, fresh = z * stddev;
+                const uint32_t replaced = 0u - static_cast<uint32_t>(u < replace);
+                const uint32_t moved = (0u - static_cast<uint32_t>(u < mutate)) & ~replaced;
+                const uint32_t kept = ~(replaced | moved);
+                weights[i] = std::bit_cast<float>((std::bit_cast<uint32_t>(w) & kept) |
+                                                  (std::bit_cast<uint32_t>(perturbed) & moved) |
+                                                  (std::bit_cast<uint32_t>(fresh) & replaced));
+        }
+        return changed;
+}
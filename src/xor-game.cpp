@@ -39,11 +39,17 @@ bool XorGame::acturate(const DataPkt& pkt){
                 assert(rand_input.at(i) == 1 || rand_input.at(i) == 0);
                 expected ^= static_cast<bool>(rand_input.at(i));
         }
-        // check correctness and continue the game
-        return expected == pkt.begin()->second;
+        // check correctness (the output node fires above 0.5) and continue the game
+        correct = expected == (pkt.begin()->second >= 0.5);
+        return correct;
 }
 
 // increase the score if the output is correct
 long double XorGame::upd_score(const long double old_score) const{
-        return old_score + 1;
+        return old_score + (correct ? 1 : 0);
+}
+
+// every correct output is worth exactly one point
+long double XorGame::max_reward() const{
+        return 1;
 }
@@ -0,0 +1,44 @@
+#include "xor-vec-env.hpp"
+#include "utility.hpp"
+#include <limits>
+#include <stdexcept>
+
+// number of lanes, input pins of the XOR gate, and max length of an episode (0 means unlimited)
+XorVecEnv::XorVecEnv(const std::size_t lanes, const std::uint32_t in_pin, const std::uint64_t max_ticks)
+        : VecEnv(lanes, in_pin, 1), in_pin{in_pin}, max_ticks{max_ticks}, ticks(lanes, 0),
+          rng(rand_select({0, std::numeric_limits<int64_t>::max()})){
+        if(in_pin < 2 || in_pin > 64) // not defined for XOR gates, and one draw holds 64 bits
+                throw std::invalid_argument(make_errmsg(__FILE__,__LINE__,"pin # must be between 2 and 64"));
+}
+
+// reset the tick counter of the lanes and draw their first bits
+void XorVecEnv::reset_lanes(const uint8_t* mask, Scalar* observations){
+        for(std::size_t lane = 0; lane < lanes(); ++lane){
+                if(!mask[lane])
+                        continue;
+                ticks[lane] = 0;
+                draw(observations + lane * in_pin);
+        }
+}
+
+// score the answers, then draw the next bits of the lanes that go on (reset_lanes draws for the ones that are done)
+void XorVecEnv::step_lanes(const Scalar* actions, Scalar* observations, Scalar* rewards, uint8_t* dones){
+        for(std::size_t lane = 0; lane < lanes(); ++lane){
+                Scalar* row = observations + lane * in_pin;
+                bool expected = false;
+                for(std::uint32_t i = 0; i < in_pin; ++i)
+                        expected ^= row[i] != 0;
+                const bool correct = expected == (actions[lane] >= 0.5);
+                rewards[lane] = correct ? 1 : 0;
+                dones[lane] = !correct || (max_ticks != 0 && ++ticks[lane] >= max_ticks);
+                if(!dones[lane])
+                        draw(row);
+        }
+}
+
+// fill the observation row of a lane with random bits
+void XorVecEnv::draw(Scalar* row){
+        std::uint64_t bits = rng();
+        for(std::uint32_t i = 0; i < in_pin; ++i, bits >>= 1)
+                row[i] = static_cast<Scalar>(bits & 1);
+}
@@ -0,0 +1,34 @@
+#include <cmath>
+#include <limits>
+#include "activation.hpp"
+#include "check.hpp"
+
+int main(){
+        // accuracy against libm, as documented in activation.hpp
+        for(float x = -20; x <= 20; x += 0.01f)
+                CHECK_NEAR(FastActivation::exp(x) / std::exp(x), 1.0f, 2e-6f);
+        for(float x = -1e4f; x <= 1e4f; x += 0.37f){
+                CHECK_NEAR(FastActivation::sin(x), std::sin(x), 5e-7f);
+                CHECK_NEAR(FastActivation::sigmoid(x), 1 / (1 + std::exp(-4.9f * x)), 5e-7f);
+                CHECK_NEAR(FastActivation::tanh(x), std::tanh(x), 5e-7f);
+        }
+
+        // out of range inputs saturate, NaN propagates (the conversions stay defined, see the sanitizer builds)
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        CHECK(std::isnan(FastActivation::exp(nan)));
+        CHECK(std::isnan(FastActivation::sin(nan)));
+        CHECK(std::isnan(FastActivation::sigmoid(nan)));
+        CHECK(std::isfinite(FastActivation::exp(1e30f)) && FastActivation::exp(1e30f) > 1e37f);
+        CHECK(FastActivation::exp(-1e30f) >= 0 && FastActivation::exp(-1e30f) < 1e-37f);
+        CHECK_NEAR(FastActivation::sigmoid(1e30f), 1.0f, 1e-7f);
+        CHECK_NEAR(FastActivation::sigmoid(-1e30f), 0.0f, 1e-7f);
+
+        // the batched sweep gives the same values as the single value version
+        float values[64];
+        for(int i = 0; i < 64; ++i)
+                values[i] = (i - 32) * 0.7f;
+        FastActivation::apply(Activation::sin, values, 64);
+        for(int i = 0; i < 64; ++i)
+                CHECK_NEAR(values[i], FastActivation::apply(Activation::sin, (i - 32) * 0.7f), 1e-6f);
+        return check_result();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cmath>
+#include <iostream>
+
+// minimal checks for the unit tests (assert() is compiled out of the default Release build)
+// - a failed check is reported and the test goes on, main returns check_result() for ctest
+
+inline int check_failures = 0;
+
+#define CHECK(cond)                                                                                     \
+        do{                                                                                             \
+                if(!(cond)){                                                                            \
+                        std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n";      \
+                        ++check_failures;                                                               \
+                }                                                                                       \
+        }while(0)
+
+#define CHECK_NEAR(a, b, tol)                                                                           \
+        do{                                                                                             \
+                const auto check_a = (a);                                                               \
+                const auto check_b = (b);                                                               \
+                if(!(std::abs(check_a - check_b) <= (tol))){                                            \
+                        std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_NEAR(" #a ", " #b ") failed: " \
+                                  << check_a << " vs " << check_b << "\n";                              \
+                        ++check_failures;                                                               \
+                }                                                                                       \
+        }while(0)
+
+// exit code of a test
+inline int check_result(){
+        if(check_failures)
+                std::cerr << check_failures << " check(s) failed\n";
+        return check_failures ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+#include <thread>
+#include <vector>
+#include "compact-gene.hpp"
+#include "genotype.hpp"
+#include "check.hpp"
+
+namespace{
+        // n connections 1 -> 2, weight i and enabled when i is even
+        CompactGenes genes(const std::size_t n){
+                CompactGenes res;
+                res.add_node(Node{.node_number = 1, .node_type = NodeType::sensor});
+                res.add_node(Node{.node_number = 2, .node_type = NodeType::output, .bias = 0.5});
+                for(std::size_t i = 0; i < n; ++i)
+                        res.add_connection(Connection{.in = 1, .out = 2, .weight = static_cast<long double>(i),
+                                                      .enable = i % 2 == 0, .innov = i + 1});
+                return res;
+        }
+
+        // the genes still hold what genes(n) put there
+        bool intact(const CompactGenes& g, const std::size_t n){
+                bool ok = g.connection_count() == n && g.node_count() == 2 && g.bias(1) == 0.5f;
+                for(std::size_t i = 0; i < n; ++i)
+                        ok = ok && g.weight(i) == static_cast<float>(i) && g.enabled(i) == (i % 2 == 0) && g.innov(i) == i + 1;
+                return ok;
+        }
+}
+
+int main(){
+        // the chunks are sized to the genes: a small genome holds a few hundred bytes, a large one about 16 per gene
+        const CompactGenes small = genes(2);
+        CHECK(intact(small, 2));
+        CHECK(small.bytes() < 400);
+        const CompactGenes large = genes(1000);
+        CHECK(intact(large, 1000));
+        CHECK(large.bytes() < 1000 * 18);
+
+        // a copy shares every chunk until it's changed, then only the chunk it changed is copied
+        CompactGenes parent = genes(200);
+        CompactGenes child = parent;
+        CHECK(parent.unique_bytes() == 0 && child.unique_bytes() == 0);
+        for(std::size_t c = 0; c < parent.weight_chunks(); ++c)
+                CHECK(parent.weights(c) == child.weights(c));
+        child.set_weight(70, -1);
+        CHECK(child.weight(70) == -1 && intact(parent, 200));
+        for(std::size_t c = 0; c < parent.weight_chunks(); ++c)
+                CHECK((parent.weights(c) == child.weights(c)) == (c != 1));
+        CHECK(child.unique_bytes() > 0 && child.unique_bytes() < child.bytes());
+
+        // the copy is written in place from then on
+        const float* const copied = child.weights(1);
+        child.set_weight(71, -2);
+        child.set_enable(72, true);
+        CHECK(child.weights(1) == copied && child.enabled(72));
+
+        // the original was flagged as shared as well: changing it does not touch the copy
+        parent.set_weight(0, -3);
+        parent.set_enable(1, true);
+        CHECK(child.weight(0) == 0 && !child.enabled(1) && parent.weight(0) == -3);
+        CHECK(parent.weights(0) != child.weights(0) && parent.weights(2) == child.weights(2));
+
+        // appending to a copy (the last chunk grows) leaves the original alone, in both directions
+        CompactGenes grown = small;
+        for(std::size_t i = 2; i < 70; ++i)
+                grown.add_connection(Connection{.in = 1, .out = 2, .weight = static_cast<long double>(i),
+                                                .enable = i % 2 == 0, .innov = i + 1});
+        CHECK(intact(grown, 70) && intact(small, 2));
+        CompactGenes appended = large;
+        appended.add_connection(Connection{.in = 2, .out = 1, .weight = 7, .enable = true, .innov = 2000});
+        CHECK(intact(large, 1000) && appended.connection_count() == 1001 && appended.weight(1000) == 7);
+        CHECK(large.weights(0) == appended.weights(0));
+
+        // copies taken and changed on several threads at once never see each other's changes
+        const CompactGenes source = genes(300);
+        std::vector<std::thread> threads;
+        std::vector<int> failures(8, 0);
+        for(std::size_t t = 0; t < failures.size(); ++t)
+                threads.emplace_back([&source, &failures, t]{
+                        for(int round = 0; round < 200; ++round){
+                                CompactGenes copy = source;
+                                for(std::size_t i = t; i < copy.connection_count(); i += 7)
+                                        copy.set_weight(i, -static_cast<float>(t) - 1);
+                                CompactGenes again = copy;
+                                again.set_weight(t, 1000);
+                                for(std::size_t i = t; i < copy.connection_count(); i += 7)
+                                        failures.at(t) += copy.weight(i) != -static_cast<float>(t) - 1;
+                        }
+                });
+        for(auto& thread : threads)
+                thread.join();
+        for(int f : failures)
+                CHECK(f == 0);
+        CHECK(intact(source, 300));
+
+        // a clone shares the genes of it's parent, but starts without a score or a behaviour of it's own
+        Genotype parent_geno(genes(100));
+        parent_geno.fitness = 3;
+        parent_geno.behaviour = {1, 2};
+        const Genotype clone = parent_geno.clone();
+        CHECK(clone.get_genes().weights(0) == parent_geno.get_genes().weights(0));
+        CHECK(clone.fitness == 0 && clone.behaviour.empty() && clone.get_id() != parent_geno.get_id());
+        return check_result();
+}
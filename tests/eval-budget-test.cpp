@@ -0,0 +1,46 @@
+#include "eval-interface.hpp"
+#include "check.hpp"
+#include "fixtures.hpp"
+
+namespace{
+        // one point on every other tick (starting with the first), never ends by itself
+        class AlternatingGame : public EvalInterface{
+            public:
+                uint64_t ticks = 0;
+
+            private:
+                void initialize(Genotype& geno) override { geno.fitness = 0, ticks = 0; }
+                DataPkt collect() const override { return {{1, 0}, {2, 1}}; }
+                bool acturate(const DataPkt&) override { return ++ticks, true; }
+                long double upd_score(const long double old_score) const override {
+                        return old_score + (ticks % 2 == 1 ? 1 : 0);
+                }
+                long double max_reward() const override { return 1; }
+        };
+}
+
+int main(){
+        Genotype geno(2, 1);
+        AlternatingGame game;
+
+        // unbounded by the threshold: runs up to the cap
+        CHECK(game.loop(geno, EvalBudget{.max_ticks = 10}) == EvalStatus::tick_limit);
+        CHECK(game.ticks == 10);
+        CHECK(geno.fitness == 5);
+
+        // 9 points out of 10 ticks: after 4 ticks the score is 2 with 6 ticks left, 9 is out of reach
+        CHECK(game.loop(geno, EvalBudget{.max_ticks = 10, .threshold = 9}) == EvalStatus::raced_out);
+        CHECK(game.ticks == 4);
+
+        // a lean pool never races a genotype out, it only runs out of ticks
+        TickPool pool(3);
+        CHECK(game.loop(geno, EvalBudget{.max_ticks = 10, .threshold = 5}, &pool) == EvalStatus::tick_limit);
+        CHECK(game.ticks == 3);
+        CHECK(pool.remaining() == 0);
+
+        // unused ticks go back to the pool
+        TickPool refunds(100);
+        CHECK(game.loop(geno, EvalBudget{.max_ticks = 10}, &refunds) == EvalStatus::tick_limit);
+        CHECK(refunds.remaining() == 90);
+        return check_result();
+}
@@ -0,0 +1,103 @@
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <stdexcept>
+#include "eval-scheduler.hpp"
+#include "utility.hpp"
+#include "check.hpp"
+#include "fixtures.hpp"
+
+namespace{
+        // runs a fixed number of ticks with deterministic inputs, sleeping a little (WITHOUT blocking) every tick,
+        // and records what went in and out of the network
+        class RecordingEnv : public CoEvalInterface{
+            public:
+                RecordingEnv(const uint64_t inputs, const std::size_t ticks, const bool drop_input = false)
+                        : inputs{inputs}, ticks{ticks}, drop_input{drop_input} {}
+
+                std::vector<DataPkt> seen_in, seen_out;
+
+            private:
+                void initialize(Genotype& geno) override { geno.fitness = 0; }
+
+                CoTask<DataPkt> collect() override {
+                        co_await delay(std::chrono::microseconds(seen_in.size() % 3));
+                        DataPkt pkt;
+                        for(uint64_t i = drop_input ? 2 : 1; i <= inputs; ++i)
+                                pkt[i] = static_cast<long double>((seen_in.size() + i) % 3) * 0.5L;
+                        seen_in.push_back(pkt);
+                        co_return pkt;
+                }
+
+                CoTask<bool> acturate(const DataPkt& pkt) override {
+                        seen_out.push_back(pkt);
+                        co_return seen_out.size() < ticks;
+                }
+
+                long double upd_score(const long double old_score) const override { return old_score + 1; }
+
+                const uint64_t inputs;
+                const std::size_t ticks;
+                const bool drop_input;
+        };
+
+        // every episode completes, and the batched propogations match the genotypes' own evaluation
+        // (networks of different sensor counts share the batches)
+        void batched_matches_scalar(){
+                constexpr std::size_t ticks = 7;
+                std::vector<Genotype> genos;
+                std::vector<std::unique_ptr<RecordingEnv>> envs;
+                for(int i = 0; i < 40; ++i){
+                        const int inputs = 2 + i % 2;
+                        genos.push_back(grown(inputs, 1 + i % 3, 15));
+                        envs.push_back(std::make_unique<RecordingEnv>(inputs, ticks));
+                }
+
+                EvalScheduler sched(2, 8);
+                for(std::size_t i = 0; i < genos.size(); ++i)
+                        sched.spawn(*envs.at(i), genos.at(i));
+                sched.run();
+
+                for(std::size_t i = 0; i < genos.size(); ++i){
+                        CHECK(genos.at(i).fitness == ticks);
+                        CHECK(envs.at(i)->seen_out.size() == ticks);
+                        for(std::size_t t = 0; t < envs.at(i)->seen_out.size(); ++t){
+                                const auto expected = genos.at(i).evaluate(envs.at(i)->seen_in.at(t));
+                                const auto& got = envs.at(i)->seen_out.at(t);
+                                CHECK(expected.size() == got.size());
+                                for(const auto& [node, value] : expected)
+                                        CHECK(got.contains(node) && got.at(node) == value);
+                        }
+                }
+        }
+
+        // a failed propogation throws inside it's own episode only, run() rethrows it once everything has ended
+        void failure_stays_in_episode(){
+                std::vector<Genotype> genos;
+                std::vector<std::unique_ptr<RecordingEnv>> envs;
+                for(int i = 0; i < 10; ++i){
+                        genos.push_back(grown(2, 1, 5));
+                        envs.push_back(std::make_unique<RecordingEnv>(2, 4, i == 3));
+                }
+
+                EvalScheduler sched(1, 4);
+                for(std::size_t i = 0; i < genos.size(); ++i)
+                        sched.spawn(*envs.at(i), genos.at(i));
+                bool thrown = false;
+                try{
+                        sched.run();
+                }catch(const std::invalid_argument&){
+                        thrown = true;
+                }
+                CHECK(thrown);
+                for(std::size_t i = 0; i < genos.size(); ++i)
+                        CHECK(envs.at(i)->seen_out.size() == (i == 3 ? 0u : 4u));
+        }
+}
+
+int main(){
+        rand_seed(26);
+        batched_matches_scalar();
+        failure_stays_in_episode();
+        return check_result();
+}
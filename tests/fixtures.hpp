@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdexcept>
+#include "genotype.hpp"
+
+// a genotype grown from the minimal network by `mutations` rounds of structural mutation
+// (a round that leaves a cyclic network is dropped)
+inline Genotype grown(const int inputs, const int outputs, const int mutations){
+        Genotype geno(inputs, outputs);
+        for(int i = 0; i < mutations; ++i){
+                Genotype child = geno.clone();
+                try{
+                        child.mutate();
+                        child.compile();
+                        geno = std::move(child);
+                }catch(const std::runtime_error&){
+                }
+        }
+        return geno;
+}
@@ -0,0 +1,127 @@
+#include <map>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include "lineage.hpp"
+#include "weight-mutation.hpp"
+#include "utility.hpp"
+#include "check.hpp"
+#include "fixtures.hpp"
+
+namespace{
+        // gene-for-gene comparison
+        bool same_genes(const CompactGenes& a, const CompactGenes& b){
+                if(a.node_count() != b.node_count() || a.connection_count() != b.connection_count())
+                        return false;
+                for(std::size_t i = 0; i < a.node_count(); ++i)
+                        if(a.node_number(i) != b.node_number(i) || a.node_type(i) != b.node_type(i) ||
+                           a.activation(i) != b.activation(i) || a.bias(i) != b.bias(i))
+                                return false;
+                for(std::size_t i = 0; i < a.connection_count(); ++i)
+                        if(a.in(i) != b.in(i) || a.out(i) != b.out(i) || a.innov(i) != b.innov(i) ||
+                           a.weight(i) != b.weight(i) || a.enabled(i) != b.enabled(i))
+                                return false;
+                return true;
+        }
+
+        std::string contents(const std::filesystem::path& file){
+                std::ifstream in(file, std::ios::binary);
+                return std::string(std::istreambuf_iterator<char>(in), {});
+        }
+}
+
+int main(){
+        rand_seed(30);
+        const auto dir = std::filesystem::temp_directory_path();
+        const auto file = dir / "neat-lineage-test.lineage", copy = dir / "neat-lineage-test-copy.lineage";
+
+        // a few lines of descent, structural and weight mutations alike; two stores record the same history
+        LineageStore store(8), twin(8);
+        std::map<uint64_t, Genotype> history;   // clones of the recorded genotypes (cloning resets the score)
+        std::map<uint64_t, long double> scores;
+        std::vector<Genotype> line{grown(3, 2, 0), grown(3, 2, 4)};
+        WeightMutation weights({.genome_rate = 0.5f, .perturb = 0.05f, .replace = 0.01f});
+        for(auto& founder : line){
+                founder.fitness = 1;
+                store.record(founder, {});
+                twin.record(founder, {});
+                history.emplace(founder.get_id(), founder.clone());
+                scores.emplace(founder.get_id(), founder.fitness);
+        }
+        for(int generation = 0; generation < 40; ++generation){
+                for(auto& parent : line){
+                        Genotype child = parent.clone();
+                        if(generation % 3 == 0){
+                                // a mutation that closes a cycle leaves a broken network, keep the plain copy then
+                                try{
+                                        Genotype mutant = parent.clone();
+                                        mutant.mutate();
+                                        mutant.compile();
+                                        child = std::move(mutant);
+                                }catch(const std::runtime_error&){
+                                }
+                        }
+                        std::vector<Genotype*> members{&child};
+                        weights.apply(members);
+                        child.fitness = generation + 0.25L;
+                        store.record(child, {parent.get_id()});
+                        twin.record(child, {parent.get_id()});
+                        history.emplace(child.get_id(), child.clone());
+                        scores.emplace(child.get_id(), child.fitness);
+                        parent = std::move(child);
+                }
+        }
+        CHECK(store.size() == history.size());
+        CHECK(store.keyframes() < store.size());
+
+        // every genotype comes back gene-for-gene, from memory and from the file
+        store.save(file);
+        const LineageStore loaded(file);
+        for(const auto& [id, geno] : history){
+                CHECK(same_genes(store.reconstruct(id).get_genes(), geno.get_genes()));
+                CHECK(same_genes(loaded.reconstruct(id).get_genes(), geno.get_genes()));
+                CHECK(store.reconstruct(id).fitness == scores.at(id));
+                CHECK(loaded.reconstruct(id).fitness == static_cast<double>(scores.at(id)));
+                CHECK(loaded.parents(id) == store.parents(id));
+        }
+
+        // the same history always gives the same file
+        twin.save(copy);
+        CHECK(contents(file) == contents(copy));
+
+        // a sparse weight change costs a few bytes, not a copy of the genes
+        Genotype child = line.front().clone();
+        LineageStore single;
+        single.record(line.front(), {});
+        single.record(child, {line.front().get_id()});
+        single.save(copy);
+        const std::size_t unchanged = contents(copy).size();
+        std::vector<Genotype*> members{&child};
+        WeightMutation one({.genome_rate = 1, .perturb = 0.02f, .replace = 0});
+        one.apply(members);
+        LineageStore sparse;
+        sparse.record(line.front(), {});
+        sparse.record(child, {line.front().get_id()});
+        sparse.save(copy);
+        CHECK(sparse.keyframes() == 1);
+        CHECK(contents(copy).size() < unchanged + 8 * (child.get_genes().connection_count() / 10 + 1));
+
+        // only the current format is read
+        {
+                std::ofstream out(file, std::ios::binary);
+                out.write("NEATLIN1", 8);
+                out.write("\x04\x00\x00\x00", 4);
+        }
+        bool rejected = false;
+        try{
+                const LineageStore other(file);
+        }catch(const std::runtime_error&){
+                rejected = true;
+        }
+        CHECK(rejected);
+
+        std::filesystem::remove(file);
+        std::filesystem::remove(copy);
+        return check_result();
+}
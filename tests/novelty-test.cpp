@@ -0,0 +1,124 @@
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include "novelty.hpp"
+#include "utility.hpp"
+#include "check.hpp"
+
+namespace{
+        // a random point on a coarse grid (so that equal distances show up as well)
+        std::vector<long double> random_point(const std::size_t dim){
+                std::vector<long double> point;
+                for(std::size_t d = 0; d < dim; ++d)
+                        point.push_back(static_cast<long double>(rand_select({-20, 20})) / 4);
+                return point;
+        }
+
+        double distance(const std::vector<long double>& a, const std::vector<long double>& b){
+                double sum = 0;
+                for(std::size_t d = 0; d < a.size(); ++d)
+                        sum += (static_cast<double>(a[d]) - static_cast<double>(b[d])) * (static_cast<double>(a[d]) - static_cast<double>(b[d]));
+                return std::sqrt(sum);
+        }
+
+        // distances to the k nearest points, ascending, by scanning every point
+        std::vector<double> brute_force(const std::vector<std::vector<long double>>& points, const std::vector<long double>& query,
+                                        const std::size_t k, const std::size_t skip = VPTree::npos){
+                std::vector<double> res;
+                for(std::size_t i = 0; i < points.size(); ++i)
+                        if(i != skip)
+                                res.push_back(distance(points.at(i), query));
+                std::sort(res.begin(), res.end());
+                res.resize(std::min(res.size(), k));
+                return res;
+        }
+
+        void check_same(const std::vector<double>& got, const std::vector<double>& expected){
+                CHECK(got.size() == expected.size());
+                for(std::size_t i = 0; i < std::min(got.size(), expected.size()); ++i)
+                        CHECK_NEAR(got.at(i), expected.at(i), 1e-12);
+        }
+}
+
+int main(){
+        rand_seed(32);
+
+        // k nearest neighbours against brute force, while the tree grows (indexed points and unindexed tail)
+        for(const std::size_t dim : {1, 3, 8}){
+                VPTree tree(dim);
+                std::vector<std::vector<long double>> points;
+                for(std::size_t n = 0; n < 600; ++n){
+                        points.push_back(random_point(dim));
+                        tree.insert(points.back());
+                        CHECK(tree.size() == points.size());
+                        if(n % 37 != 0)
+                                continue;
+                        for(const std::size_t k : {1, 5, 40}){
+                                const std::vector<long double> query = random_point(dim);
+                                check_same(tree.nearest(query, k), brute_force(points, query, k));
+                                const std::size_t skip = static_cast<std::size_t>(rand_select({0, static_cast<int64_t>(n)}));
+                                check_same(tree.nearest(points.at(skip), k, skip), brute_force(points, points.at(skip), k, skip));
+                        }
+                }
+                tree.rebuild();
+                const std::vector<long double> query = random_point(dim);
+                check_same(tree.nearest(query, points.size() + 3), brute_force(points, query, points.size() + 3));
+                check_same(tree.nearest(query, 0), {});
+        }
+
+        // novelty of a population: mean distance to the k nearest of the other members and the archive
+        constexpr std::size_t k = 4;
+        constexpr long double threshold = 2;
+        NoveltySearch novelty(k, threshold, 3);
+        std::vector<std::vector<long double>> archived;
+        for(int round = 0; round < 3; ++round){
+                std::vector<Genotype> pop;
+                for(int i = 0; i < 50; ++i){
+                        pop.emplace_back(1, 1);
+                        pop.back().behaviour = random_point(2);
+                }
+                std::vector<Genotype*> members;
+                std::vector<std::vector<long double>> behaviours;
+                for(auto& geno : pop)
+                        members.push_back(&geno), behaviours.push_back(geno.behaviour);
+                novelty.assign(members);
+
+                std::vector<std::vector<long double>> added;
+                for(std::size_t i = 0; i < pop.size(); ++i){
+                        std::vector<double> near = brute_force(behaviours, behaviours.at(i), k, i);
+                        const std::vector<double> old = brute_force(archived, behaviours.at(i), k);
+                        near.insert(near.end(), old.begin(), old.end());
+                        std::sort(near.begin(), near.end());
+                        near.resize(k);
+                        const long double expected = std::accumulate(near.begin(), near.end(), 0.0L) / k;
+                        CHECK_NEAR(pop.at(i).fitness, expected, 1e-9L);
+                        if(expected > threshold)
+                                added.push_back(behaviours.at(i));
+                }
+                archived.insert(archived.end(), added.begin(), added.end());
+                CHECK(novelty.archive_size() == archived.size());
+        }
+
+        // descriptors of another dimension than the archive's are rejected on the calling thread, scores untouched
+        std::vector<Genotype> other;
+        for(int i = 0; i < 20; ++i){
+                other.emplace_back(1, 1);
+                other.back().behaviour = random_point(3);
+                other.back().fitness = -1;
+        }
+        std::vector<Genotype*> members;
+        for(auto& geno : other)
+                members.push_back(&geno);
+        bool thrown = false;
+        try{
+                novelty.assign(members);
+        }catch(const std::invalid_argument&){
+                thrown = true;
+        }
+        CHECK(thrown);
+        CHECK(std::all_of(other.begin(), other.end(), [](const Genotype& g){ return g.fitness == -1; }));
+        CHECK(novelty.archive_size() == archived.size());
+        return check_result();
+}
@@ -0,0 +1,44 @@
+#include <vector>
+#include <memory>
+#include "population-kernel.hpp"
+#include "utility.hpp"
+#include "check.hpp"
+#include "fixtures.hpp"
+
+int main(){
+        rand_seed(27);
+        constexpr std::size_t batch = 13;
+
+        // a population of different topologies, evaluated both packed and one network at a time
+        std::vector<Genotype> genos;
+        std::vector<std::shared_ptr<const CompiledNet>> nets;
+        for(int i = 0; i < 12; ++i){
+                genos.push_back(grown(3, 1 + i % 2, i * 3));
+                nets.push_back(genos.back().compile());
+        }
+
+        for(const bool shared : {true, false}){
+                const std::size_t blocks = shared ? 1 : nets.size();
+                std::vector<PopulationKernel::Scalar> inputs;
+                for(std::size_t i = 0; i < blocks * 3 * batch; ++i)
+                        inputs.push_back(static_cast<PopulationKernel::Scalar>(rand_select({-100, 100})) / 50);
+
+                PopulationKernel kernel(nets, shared);
+                kernel.evaluate(inputs, batch);
+                CHECK(kernel.size() == nets.size());
+                for(std::size_t n = 0; n < nets.size(); ++n){
+                        const std::size_t block = shared ? 0 : n;
+                        for(std::size_t b = 0; b < batch; ++b){
+                                CompiledNet::DataPkt pkt;
+                                for(std::size_t s = 0; s < 3; ++s)
+                                        pkt[nets.at(n)->node_ids.at(s)] = inputs.at((block * 3 + s) * batch + b);
+                                const auto expected = nets.at(n)->evaluate(pkt);
+                                CHECK(expected.size() == kernel.outputs(n));
+                                std::size_t k = 0;
+                                for(const auto& [node, value] : expected)
+                                        CHECK(kernel.output(n, k++)[b] == static_cast<PopulationKernel::Scalar>(value));
+                        }
+                }
+        }
+        return check_result();
+}
@@ -0,0 +1,106 @@
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "quantized-net.hpp"
+#include "utility.hpp"
+#include "check.hpp"
+#include "fixtures.hpp"
+
+namespace{
+        using Scalar = QuantizedNet::Scalar;
+
+        std::vector<QuantizedNet::Sample> random_samples(const std::size_t sensors, const std::size_t count){
+                std::vector<QuantizedNet::Sample> samples(count);
+                for(auto& sample : samples)
+                        for(std::size_t s = 0; s < sensors; ++s)
+                                sample.push_back(static_cast<Scalar>(rand_select({-1000, 1000})) / 1000);
+                return samples;
+        }
+
+        // largest magnitude of an output of the float network over the samples
+        Scalar output_peak(const CompiledNet& net, const std::vector<QuantizedNet::Sample>& samples){
+                Scalar peak = 0;
+                for(auto& sample : samples){
+                        CompiledNet::DataPkt pkt;
+                        for(std::size_t s = 0; s < sample.size(); ++s)
+                                pkt[net.node_ids.at(s)] = sample.at(s);
+                        for(const auto& [node, value] : net.evaluate(pkt))
+                                peak = std::max(peak, static_cast<Scalar>(std::abs(value)));
+                }
+                return peak;
+        }
+}
+
+int main(){
+        rand_seed(34);
+
+        // random topologies: the error against the float network stays within a few int8 steps of the output range
+        for(int i = 0; i < 30; ++i){
+                Genotype geno = grown(3, 2, i);
+                const CompiledNet& net = *geno.compile();
+                const std::vector<QuantizedNet::Sample> samples = random_samples(3, 200);
+                const QuantizedNet quantized(net, samples);
+                const QuantizedNet::Report report = quantized.compare(net, samples);
+                const Scalar range = std::max<Scalar>(output_peak(net, samples), 1);
+                CHECK(report.samples == samples.size());
+                CHECK(report.max_abs_error <= 0.05f * range);
+                CHECK(report.mean_abs_error <= 0.01f * range);
+                CHECK(report.quantized_bytes > 0);
+
+                // both evaluate overloads agree
+                std::vector<Scalar> out;
+                quantized.evaluate(samples.front(), out);
+                CHECK(out == quantized.evaluate(samples.front()));
+        }
+
+        // a node summing thousands of inputs: the accumulator range is far wider than the lookup table, the table
+        // index multiplier must not round down to 0
+        constexpr uint64_t wide = 3000;
+        std::vector<Node> nodes;
+        std::vector<Connection> connections;
+        for(uint64_t n = 1; n <= wide; ++n){
+                nodes.push_back(Node{.node_number = n, .node_type = NodeType::sensor});
+                connections.push_back(Connection{.in = n, .out = wide + 1, .weight = 1, .enable = true, .innov = 1});
+        }
+        nodes.push_back(Node{.node_number = wide + 1, .node_type = NodeType::output, .activation = Activation::identity});
+        const CompiledNet net(CompactGenes(nodes, connections));
+        std::vector<QuantizedNet::Sample> samples = {QuantizedNet::Sample(wide, 1), QuantizedNet::Sample(wide, -1)};
+        for(Scalar fraction : {0.25f, 0.5f, 0.75f}){
+                QuantizedNet::Sample sample(wide, -1);
+                std::fill(sample.begin(), sample.begin() + static_cast<std::size_t>(fraction * wide), 1);
+                samples.push_back(sample);
+        }
+        const QuantizedNet quantized(net, samples);
+        const QuantizedNet::Report report = quantized.compare(net, samples);
+        CHECK(report.max_abs_error <= 0.02f * wide);
+
+        // a bias far larger than the weights still fits in the accumulator
+        const CompiledNet biased(CompactGenes(
+                std::vector<Node>{Node{.node_number = 1, .node_type = NodeType::sensor},
+                                  Node{.node_number = 2, .node_type = NodeType::output, .activation = Activation::identity, .bias = 1000}},
+                std::vector<Connection>{Connection{.in = 1, .out = 2, .weight = 1e-4L, .enable = true, .innov = 1}}));
+        const std::vector<QuantizedNet::Sample> inputs = random_samples(1, 50);
+        CHECK(QuantizedNet(biased, inputs).compare(biased, inputs).max_abs_error <= 0.02f * 1000);
+
+        // an identity node calibrated on [-1, 1] is as accurate at the top of the range as at the bottom: the table
+        // index must point at the bucket whose center is nearest, not drift upwards
+        const CompiledNet identity(CompactGenes(
+                std::vector<Node>{Node{.node_number = 1, .node_type = NodeType::sensor},
+                                  Node{.node_number = 2, .node_type = NodeType::output, .activation = Activation::identity}},
+                std::vector<Connection>{Connection{.in = 1, .out = 2, .weight = 1, .enable = true, .innov = 1}}));
+        std::vector<QuantizedNet::Sample> range;
+        for(int i = -1000; i <= 1000; ++i)
+                range.push_back({static_cast<Scalar>(i) / 1000});
+        const QuantizedNet line(identity, range);
+        Scalar below = 0, above = 0;
+        for(auto& sample : range){
+                const Scalar error = std::abs(line.evaluate(sample).at(0) - sample.at(0));
+                Scalar& worst = sample.at(0) < 0 ? below : above;
+                worst = std::max(worst, error);
+        }
+        CHECK(below <= 1.0f / 127 && above <= 1.0f / 127);
+        CHECK(std::abs(line.evaluate({0.98f}).at(0) - 0.98f) <= 1.0f / 127);
+        CHECK(std::abs(line.evaluate({-0.98f}).at(0) + 0.98f) <= 1.0f / 127);
+
+        return check_result();
+}
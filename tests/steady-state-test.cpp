@@ -0,0 +1,147 @@
+#include <vector>
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include "steady-state.hpp"
+#include "xor-game.hpp"
+#include "utility.hpp"
+#include "check.hpp"
+#include "fixtures.hpp"
+
+// reaches into SteadyState (see the friend declaration)
+struct SteadyStateProbing{
+        static void insert(SteadyState& evolution, std::shared_ptr<Genotype> geno) { evolution.insert(std::move(geno)); }
+        static long double survival_threshold(const SteadyState& evolution) { return evolution.survival_threshold(); }
+
+        // whether the genotype is still in the population
+        static bool alive(const SteadyState& evolution, const std::shared_ptr<Genotype>& geno){
+                for(auto& s : evolution.species)
+                        if(std::find(s.members.begin(), s.members.end(), geno) != s.members.end())
+                                return true;
+                return false;
+        }
+
+        // every species is represented by it's fittest current member
+        static bool represented(const SteadyState& evolution){
+                for(auto& s : evolution.species){
+                        if(std::find(s.members.begin(), s.members.end(), s.representative) == s.members.end())
+                                return false;
+                        for(auto& member : s.members)
+                                if(member->fitness > s.representative->fitness)
+                                        return false;
+                }
+                return true;
+        }
+};
+
+namespace{
+        // every tick is worth `reward` (at most 1), the episode never ends by itself
+        class FixedReward : public EvalInterface{
+            public:
+                explicit FixedReward(const long double reward) : reward{reward} {}
+            private:
+                void initialize(Genotype& geno) override { geno.fitness = 0; }
+                DataPkt collect() const override { return {{1, 0}, {2, 0}}; }
+                bool acturate(const DataPkt&) override { return true; }
+                long double upd_score(const long double old_score) const override { return old_score + reward; }
+                long double max_reward() const override { return 1; }
+                const long double reward;
+        };
+
+        std::shared_ptr<Genotype> scored(const Genotype& geno, const long double fitness){
+                auto res = std::make_shared<Genotype>(geno.clone());
+                res->fitness = fitness;
+                return res;
+        }
+
+        SteadyState probe(const std::size_t capacity){
+                SteadyState::Config config;
+                config.capacity = capacity;
+                config.threads = 1;
+                // only identical topologies share a species
+                config.compat_threshold = 1e-9L;
+                return SteadyState(2, 1, config, []{ return std::make_unique<FixedReward>(1); });
+        }
+
+        // the individual retired is the one with the lowest fitness shared within it's species, and the species
+        // representatives stay current members
+        void retires_lowest_adjusted(){
+                const Genotype a(2, 1), b = grown(2, 1, 3), c = grown(2, 1, 6);
+                CHECK(Genotype::distance(a, b, 1, 0.4L) > 1e-9L && Genotype::distance(a, c, 1, 0.4L) > 1e-9L &&
+                      Genotype::distance(b, c, 1, 0.4L) > 1e-9L);
+                SteadyState evolution = probe(3);
+                // species a: 10 and 10 shared by 2 (5 each), species b: 6 alone
+                const auto a1 = scored(a, 10), a2 = scored(a, 10), b1 = scored(b, 6);
+                SteadyStateProbing::insert(evolution, a1);
+                SteadyStateProbing::insert(evolution, a2);
+                SteadyStateProbing::insert(evolution, b1);
+                CHECK(evolution.size() == 3 && evolution.species_count() == 2);
+
+                // a newcomer of 7 in it's own species: one of species a goes (5), not the lowest raw score (6)
+                const auto c1 = scored(c, 7);
+                SteadyStateProbing::insert(evolution, c1);
+                CHECK(evolution.size() == 3 && evolution.species_count() == 3);
+                CHECK(SteadyStateProbing::alive(evolution, b1) && SteadyStateProbing::alive(evolution, c1));
+                CHECK(SteadyStateProbing::alive(evolution, a1) != SteadyStateProbing::alive(evolution, a2));
+                CHECK(SteadyStateProbing::represented(evolution));
+
+                // a fitter member of species b becomes it's representative, the retired one is not kept around
+                const auto b2 = scored(b, 30);
+                SteadyStateProbing::insert(evolution, b2);
+                CHECK(SteadyStateProbing::represented(evolution));
+                CHECK(evolution.best() == b2);
+        }
+
+        // once the population is full an offspring that cannot beat the survival threshold is raced out, and it
+        // would indeed have been the one retired on arrival
+        void races_out_losers(){
+                const Genotype a(2, 1);
+                SteadyState evolution = probe(4);
+                for(int i = 0; i < 3; ++i)
+                        SteadyStateProbing::insert(evolution, scored(a, 8));
+                // not full yet: nobody is raced
+                CHECK(SteadyStateProbing::survival_threshold(evolution) == -std::numeric_limits<long double>::infinity());
+                SteadyStateProbing::insert(evolution, scored(a, 8));
+                // 4 members of 8 in one species: a newcomer shares by 5, below 8 / 5 it's the lowest whatever it joins
+                const long double threshold = SteadyStateProbing::survival_threshold(evolution);
+                CHECK_NEAR(threshold, 8.0L / 5, 1e-12L);
+
+                EvalBudget budget{.max_ticks = 10, .threshold = threshold};
+                auto loser = std::make_shared<Genotype>(a.clone()), winner = std::make_shared<Genotype>(a.clone());
+                FixedReward nothing(0), full(1);
+                CHECK(nothing.loop(*loser, budget) == EvalStatus::raced_out);
+                CHECK(full.loop(*winner, budget) == EvalStatus::tick_limit && winner->fitness == 10);
+
+                SteadyStateProbing::insert(evolution, loser);
+                CHECK(!SteadyStateProbing::alive(evolution, loser));
+                SteadyStateProbing::insert(evolution, winner);
+                CHECK(SteadyStateProbing::alive(evolution, winner));
+        }
+
+        // fitness of every individual after a seeded single worker run, plus the species count
+        std::vector<long double> evolve(const uint64_t seed){
+                rand_seed(seed);
+                SteadyState::Config config;
+                config.capacity = 30;
+                config.threads = 1;
+                config.budget.max_ticks = 50;
+                SteadyState evolution(2, 1, config, []{ return std::make_unique<XorGame>(2); });
+                evolution.run(300);
+                CHECK(evolution.size() == config.capacity);
+
+                std::vector<long double> res{static_cast<long double>(evolution.species_count())};
+                res.push_back(evolution.best()->fitness);
+                res.push_back(static_cast<long double>(evolution.mutation_failures()));
+                return res;
+        }
+}
+
+int main(){
+        // a single worker run is reproducible from the seed
+        const auto first = evolve(28), second = evolve(28);
+        CHECK(first == second);
+
+        retires_lowest_adjusted();
+        races_out_losers();
+        return check_result();
+}
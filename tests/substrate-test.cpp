@@ -0,0 +1,64 @@
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "substrate.hpp"
+#include "activation.hpp"
+#include "check.hpp"
+
+namespace{
+        // CPPN whose output is activation(x1)
+        Genotype cppn(const Activation activation){
+                std::vector<Node> nodes;
+                std::vector<Connection> connections;
+                for(uint64_t i = 1; i <= 4; ++i){
+                        nodes.push_back(Node{.node_number = i, .node_type = NodeType::sensor});
+                        connections.push_back(Connection{.in = i, .out = 5, .weight = i == 1 ? 1.0L : 0.0L, .enable = true, .innov = 1});
+                }
+                nodes.push_back(Node{.node_number = 5, .node_type = NodeType::output, .activation = activation});
+                return Genotype(CompactGenes(nodes, connections));
+        }
+}
+
+int main(){
+        using Scalar = Substrate::Scalar;
+        constexpr Scalar threshold = 0.2f, max_weight = 3.0f;
+        const std::vector<Scalar> xs = {-3, -0.9f, -0.1f, 0.3f, 0.9f, 2};
+
+        // the expected weight in [-1, 1] for each output activation function
+        struct Case{
+                Activation activation;
+                Scalar (*weight)(Scalar);
+        };
+        const std::vector<Case> cases = {
+                {Activation::sigmoid, [](Scalar x){ return Scalar(2 / (1 + std::exp(-4.9 * x)) - 1); }},
+                {Activation::gaussian, [](Scalar x){ return Scalar(2 * std::exp(-x * x) - 1); }},
+                {Activation::tanh, [](Scalar x){ return Scalar(std::tanh(x)); }},
+                {Activation::sin, [](Scalar x){ return Scalar(std::sin(x)); }},
+                {Activation::relu, [](Scalar x){ return std::clamp<Scalar>(x, 0, 1); }},
+                {Activation::identity, [](Scalar x){ return std::clamp<Scalar>(x, -1, 1); }},
+        };
+
+        // one substrate input per x, a single output node: feeding a one-hot input reads back one weight
+        std::vector<Substrate::Point> inputs;
+        for(Scalar x : xs)
+                inputs.push_back({x, 0});
+        Substrate substrate({inputs, {{0, 0}}});
+
+        for(const Case& c : cases){
+                Genotype geno = cppn(c.activation);
+                substrate.build(geno, threshold, max_weight);
+                std::size_t kept = 0;
+                for(std::size_t i = 0; i < xs.size(); ++i){
+                        const Scalar w = c.weight(xs.at(i));
+                        Scalar expected = 0;
+                        if(std::abs(w) > threshold)
+                                expected = std::copysign((std::abs(w) - threshold) / (1 - threshold) * max_weight, w), ++kept;
+
+                        std::vector<Scalar> onehot(xs.size(), 0);
+                        onehot.at(i) = 1;
+                        CHECK_NEAR(substrate.evaluate(onehot).at(0), FastActivation::apply(Activation::sigmoid, expected), 1e-4);
+                }
+                CHECK(substrate.connections() == kept);
+        }
+        return check_result();
+}
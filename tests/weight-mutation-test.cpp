@@ -0,0 +1,74 @@
+#include <vector>
+#include "weight-mutation.hpp"
+#include "utility.hpp"
+#include "check.hpp"
+#include "fixtures.hpp"
+
+namespace{
+        bool same_weights(const Genotype& a, const Genotype& b){
+                bool same = a.get_genes().connection_count() == b.get_genes().connection_count();
+                for(std::size_t i = 0; same && i < a.get_genes().connection_count(); ++i)
+                        same = a.get_genes().weight(i) == b.get_genes().weight(i);
+                return same;
+        }
+}
+
+int main(){
+        rand_seed(39);
+        Genotype parent = grown(3, 2, 8);
+        const std::size_t count = parent.get_genes().connection_count();
+        parent.compile();
+        std::vector<float> weights;
+        for(std::size_t i = 0; i < count; ++i)
+                weights.push_back(parent.get_genes().weight(i));
+
+        // every weight of an offspring perturbed: the parent keeps it's weights, the offspring drops it's network
+        WeightMutation all({.genome_rate = 1, .perturb = 1, .replace = 0});
+        Genotype child = parent.clone();
+        const auto before = child.compile();
+        CHECK(count > 0 && all.apply(child) == count);
+        for(std::size_t i = 0; i < count; ++i)
+                CHECK(child.get_genes().weight(i) != parent.get_genes().weight(i));
+        CHECK(child.compile() != before);
+        for(std::size_t i = 0; i < count; ++i)
+                CHECK(parent.get_genes().weight(i) == weights.at(i));
+
+        // a genotype left out keeps it's weights and it's network
+        WeightMutation none({.genome_rate = 0});
+        Genotype kept = parent.clone();
+        const auto net = kept.compile();
+        CHECK(none.apply(kept) == 0);
+        CHECK(same_weights(kept, parent) && kept.compile() == net);
+
+        // genome_rate is the fraction of the offspring that take part
+        WeightMutation half({.genome_rate = 0.5f});
+        std::size_t mutated = 0;
+        for(int i = 0; i < 1000; ++i){
+                Genotype offspring = parent.clone();
+                half.apply(offspring);
+                mutated += !same_weights(offspring, parent);
+        }
+        CHECK(mutated > 400 && mutated < 600);
+
+        // the population pass is the per offspring pass over every member, in order
+        std::vector<Genotype> batch, single;
+        for(int i = 0; i < 20; ++i){
+                batch.push_back(grown(3, 2, i % 7));
+                single.push_back(batch.back().clone());
+        }
+        std::vector<Genotype*> members;
+        for(auto& geno : batch)
+                members.push_back(&geno);
+        rand_seed(390);
+        WeightMutation population({});
+        const std::size_t changed = population.apply(members);
+        rand_seed(390);
+        WeightMutation per_offspring({});
+        std::size_t sum = 0;
+        for(auto& geno : single)
+                sum += per_offspring.apply(geno);
+        CHECK(changed == sum);
+        for(std::size_t i = 0; i < batch.size(); ++i)
+                CHECK(same_weights(batch.at(i), single.at(i)));
+        return check_result();
+}
@@ -0,0 +1,110 @@
+#include <vector>
+#include "xor-vec-env.hpp"
+#include "xor-game.hpp"
+#include "utility.hpp"
+#include "check.hpp"
+#include "fixtures.hpp"
+
+namespace{
+        using Scalar = VecEnv::Scalar;
+
+        // hand wired 2 pin XOR: h4 = OR(a, b), h5 = AND(a, b), out = h4 and not h5 (the opposite when inverted)
+        Genotype xor_net(const bool inverted){
+                const long double sign = inverted ? -1 : 1;
+                return Genotype(CompactGenes(
+                        std::vector<Node>{{.node_number = 1, .node_type = NodeType::sensor},
+                                          {.node_number = 2, .node_type = NodeType::sensor},
+                                          {.node_number = 3, .node_type = NodeType::output, .bias = -10 * sign},
+                                          {.node_number = 4, .node_type = NodeType::hidden, .bias = -10},
+                                          {.node_number = 5, .node_type = NodeType::hidden, .bias = -30}},
+                        std::vector<Connection>{{.in = 1, .out = 4, .weight = 20, .enable = true, .innov = 1},
+                                                {.in = 2, .out = 4, .weight = 20, .enable = true, .innov = 1},
+                                                {.in = 1, .out = 5, .weight = 20, .enable = true, .innov = 1},
+                                                {.in = 2, .out = 5, .weight = 20, .enable = true, .innov = 1},
+                                                {.in = 4, .out = 3, .weight = 20 * sign, .enable = true, .innov = 1},
+                                                {.in = 5, .out = 3, .weight = -20 * sign, .enable = true, .innov = 1}}));
+        }
+}
+
+int main(){
+        rand_seed(37);
+        constexpr std::uint32_t pins = 2;
+        constexpr std::size_t per = 8;
+        constexpr uint64_t ticks = 120, max_ticks = 25;
+
+        // evolved topologies of all sorts, plus a perfect player and a player that is always wrong
+        std::vector<Genotype> pop;
+        for(int i = 0; i < 10; ++i)
+                pop.push_back(grown(pins, 1, i * 2));
+        pop.push_back(xor_net(false));
+        pop.push_back(xor_net(true));
+        std::vector<Genotype*> members;
+        for(auto& geno : pop)
+                members.push_back(&geno);
+        const std::size_t lanes = pop.size() * per;
+
+        // vectorized: every network propogated by one PopulationKernel pass per tick
+        rand_seed(370);
+        XorVecEnv env(lanes, pins, max_ticks);
+        VecEvaluator evaluator(members);
+        const uint64_t episodes = evaluator.run(env, ticks);
+        std::vector<long double> vectorized;
+        for(auto& geno : pop)
+                vectorized.push_back(geno.fitness);
+
+        // scalar: the same bits (same seed), each lane answered by it's genotype one packet at a time, and every
+        // reward checked against the parity of the bits
+        rand_seed(370);
+        XorVecEnv replay(lanes, pins, max_ticks);
+        replay.reset();
+        std::vector<long double> score(pop.size(), 0);
+        uint64_t finished = 0;
+        std::vector<Scalar> actions(lanes), expected(lanes);
+        for(uint64_t t = 0; t < ticks; ++t){
+                for(std::size_t lane = 0; lane < lanes; ++lane){
+                        const Scalar* row = replay.observations().data() + lane * pins;
+                        Genotype::DataPkt pkt;
+                        bool parity = false;
+                        for(std::uint32_t i = 0; i < pins; ++i)
+                                pkt[i + 1] = row[i], parity ^= row[i] != 0;
+                        actions[lane] = static_cast<Scalar>(pop.at(lane / per).evaluate(pkt).begin()->second);
+                        expected[lane] = parity == (actions[lane] >= 0.5) ? 1 : 0;
+                }
+                replay.step(actions);
+                for(std::size_t lane = 0; lane < lanes; ++lane){
+                        CHECK(replay.rewards()[lane] == expected[lane]);
+                        score[lane / per] += replay.rewards()[lane];
+                        finished += replay.dones()[lane];
+                }
+        }
+        CHECK(episodes == finished);
+        for(std::size_t n = 0; n < pop.size(); ++n)
+                CHECK(vectorized.at(n) == score.at(n) / per);
+
+        // the hand wired players score the same in the scalar game
+        CHECK(vectorized.at(pop.size() - 2) == ticks);
+        CHECK(vectorized.at(pop.size() - 1) == 0);
+        XorGame game(pins);
+        const EvalBudget budget{.max_ticks = max_ticks};
+        game.loop(pop.at(pop.size() - 2), budget);
+        CHECK(pop.at(pop.size() - 2).fitness == max_ticks);
+        game.loop(pop.at(pop.size() - 1), budget);
+        CHECK(pop.at(pop.size() - 1).fitness == 0);
+
+        // a lane that is done takes one draw per tick, as a reset does: wrong answers walk the same bits as resets
+        rand_seed(371);
+        XorVecEnv wrong(1, 64, 0);
+        wrong.reset();
+        rand_seed(371);
+        XorVecEnv resets(1, 64, 0);
+        resets.reset();
+        for(int t = 0; t < 20; ++t){
+                bool parity = false;
+                for(Scalar bit : wrong.observations())
+                        parity ^= bit != 0;
+                wrong.step({parity ? Scalar(0) : Scalar(1)});
+                resets.reset();
+                CHECK(wrong.dones()[0] == 1 && wrong.observations() == resets.observations());
+        }
+        return check_result();
+}